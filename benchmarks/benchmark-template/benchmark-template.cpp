@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+#include <common/common.h>
+#include <common/uut.h>
+
+using namespace lldc::testing;
+
+static void
+set_counters (benchmark::State &state, size_t bytes)
+{
+  state.SetBytesProcessed(state.iterations() * bytes);
+  // Every thread reports the same size; average it rather than summing it over threads.
+  state.counters["bytes/op"] = benchmark::Counter(bytes, benchmark::Counter::kAvgThreads);
+  state.counters["messages/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+template <typename T>
+static void
+BM_To (benchmark::State &state)
+{
+  T input;
+  fill_example(input);
+
+  uut_type temp = to_conversion(input);
+  const size_t bytes = uut_size(temp);
+  uut_unref(temp);
+
+  for (auto _ : state) {
+    temp = to_conversion(input);
+    benchmark::DoNotOptimize(temp);
+    uut_unref(temp);
+  }
+
+  set_counters(state, bytes);
+}
+
+template <typename T>
+static void
+BM_From (benchmark::State &state)
+{
+  T input;
+  fill_example(input);
+
+  uut_type temp = to_conversion(input);
+  const size_t bytes = uut_size(temp);
+
+  // Each iteration decodes into a new message, as a receiver would; its
+  // construction and destruction are part of the time.
+  for (auto _ : state) {
+    T output;
+    if (!from_conversion(temp, output)) {
+      state.SkipWithError("from conversion failed");
+      break;
+    }
+    benchmark::DoNotOptimize(output);
+  }
+
+  uut_unref(temp);
+  set_counters(state, bytes);
+}
+
+#define BENCHMARK_MESSAGE(T) \
+  BENCHMARK_TEMPLATE(BM_To, T); \
+  BENCHMARK_TEMPLATE(BM_From, T)
+
+BENCHMARK_MESSAGE(FirstMessage);
+BENCHMARK_MESSAGE(SecondMessage);
+BENCHMARK_MESSAGE(OptionalMemberMessage);
+BENCHMARK_MESSAGE(SimpleMessage);
+BENCHMARK_MESSAGE(MessageWithAnys);
+BENCHMARK_MESSAGE(MessageWithVectors);
+BENCHMARK_MESSAGE(MessageWithBlob);
+BENCHMARK_MESSAGE(MaybeEmpty);
+
+// Multi-core scaling: every thread converts its own copy of the message
+// with its own context, from 1 thread up to one per hardware thread.  With
+// real time, messages/s is the aggregate rate across all threads.
+static const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+#define BENCHMARK_SCALING(T) \
+  BENCHMARK_TEMPLATE(BM_To, T)->ThreadRange(1, max_threads)->UseRealTime(); \
+  BENCHMARK_TEMPLATE(BM_From, T)->ThreadRange(1, max_threads)->UseRealTime()
+
+BENCHMARK_SCALING(SecondMessage);
+BENCHMARK_SCALING(OptionalMemberMessage);
+BENCHMARK_SCALING(MessageWithVectors);
+
+BENCHMARK_MAIN();
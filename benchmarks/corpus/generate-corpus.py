@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+#
+# Copyright 2023 Laerdal Labs, DC
+#   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+#
+# Generates synthetic RTTR-registered message types, and the code to fill
+# them with a deterministic corpus, for the throughput benchmark.  Each
+# --shape describes one family of types:
+#
+#   --shape NAME:key=value,key=value,...
+#
+#     depth       levels of nested objects (1 = a single flat type)
+#     properties  properties per type
+#     optional    share of properties registered as optional (half of those
+#                 with a default)
+#     any         share of properties that are std::map<std::string, std::any>
+#     pointer     share of nested objects held by std::shared_ptr
+#     sequence    share of properties that are std::vector<int64_t>
+#     access      share of members registered with in_place_property
+#     seed        seed for choosing the above
+#
+# The root type of a shape deeper than 1 also has an 'items' vector of its
+# child type.  Its length, and that of every other container, is chosen when
+# the corpus is filled, not here.
+
+import argparse
+import os
+import random
+
+DEFAULTS = {
+  'depth': 1,
+  'properties': 16,
+  'optional': 0.0,
+  'any': 0.0,
+  'pointer': 0.0,
+  'sequence': 0.1,
+  'access': 1.0,
+  'seed': 1,
+}
+
+# (C++ type, default for set_is_optional_with_default, fill expression)
+SCALARS = [
+  ('int64_t',     'int64_t(0)',    'static_cast<int64_t>(seed * {i})'),
+  ('uint32_t',    'uint32_t(0)',   'static_cast<uint32_t>(seed + {i})'),
+  ('double',      'double(0.0)',   'static_cast<double>(seed) / {i}.0'),
+  ('bool',        'false',         '((seed + {i}) % 2) == 0'),
+  ('std::string', 'std::string()', '"value-" + std::to_string(seed + {i})'),
+]
+
+
+def parse_shape(text):
+  name, _, settings = text.partition(':')
+  shape = dict(DEFAULTS)
+  for setting in filter(None, settings.split(',')):
+    key, _, value = setting.partition('=')
+    if key not in DEFAULTS:
+      raise SystemExit('unknown shape setting: ' + key)
+    shape[key] = type(DEFAULTS[key])(value)
+  shape['name'] = name
+  return shape
+
+
+class Property:
+  def __init__(self, name, kind, cpp_type, child=None, default=None, fill=None):
+    self.name = name
+    self.kind = kind          # scalar, sequence, any, object, pointer, items
+    self.cpp_type = cpp_type
+    self.child = child
+    self.default = default
+    self.fill = fill
+    self.optional = False
+    self.defaulted = False
+    self.access = False
+
+
+def plan_level(shape, level, rng):
+  depth = shape['depth']
+  child = 'Level{}'.format(level + 1) if level + 1 < depth else None
+  props = []
+
+  if child:
+    if level == 0:
+      props.append(Property('items', 'items', 'std::vector<{}>'.format(child), child))
+    if rng.random() < shape['pointer']:
+      props.append(Property('child', 'pointer', 'std::shared_ptr<{}>'.format(child), child))
+    else:
+      props.append(Property('child', 'object', child, child))
+
+  i = 0
+  while len(props) < shape['properties']:
+    i += 1
+    roll = rng.random()
+    if roll < shape['any']:
+      prop = Property('any_{}'.format(i), 'any', 'std::map<std::string, std::any>')
+    elif roll < shape['any'] + shape['sequence']:
+      prop = Property('sequence_{}'.format(i), 'sequence', 'std::vector<int64_t>')
+    else:
+      cpp_type, default, fill = SCALARS[i % len(SCALARS)]
+      prop = Property('scalar_{}'.format(i), 'scalar', cpp_type, default=default, fill=fill.format(i=i))
+
+    if rng.random() < shape['optional']:
+      prop.optional = True
+      prop.defaulted = (prop.kind == 'scalar' and rng.random() < 0.5)
+    props.append(prop)
+
+  for prop in props:
+    prop.access = (prop.kind != 'pointer' and rng.random() < shape['access'])
+  return props
+
+
+def generate(shapes):
+  header = [
+    '// Generated by benchmarks/corpus/generate-corpus.py; do not edit.',
+    '#pragma once',
+    '',
+    '#include <any>',
+    '#include <cstddef>',
+    '#include <cstdint>',
+    '#include <map>',
+    '#include <memory>',
+    '#include <string>',
+    '#include <vector>',
+    '',
+    '#include <rttr/type>',
+    '',
+  ]
+  source = [
+    '// Generated by benchmarks/corpus/generate-corpus.py; do not edit.',
+    '#include "synthetic.h"',
+    '',
+    '#include <lldc-reflection/registration.h>',
+    '',
+  ]
+  registration = []
+  shape_list = []
+
+  for shape in shapes:
+    ns = 'lldc::benchmarking::{}'.format(shape['name'])
+    rng = random.Random(shape['seed'])
+    levels = [plan_level(shape, level, rng) for level in range(shape['depth'])]
+    shape_list.append('X({}, {})'.format(shape['name'], 'true' if shape['depth'] > 1 else 'false'))
+
+    header.append('namespace {} {{'.format(ns))
+    source.append('namespace {} {{'.format(ns))
+
+    # Deepest level first, so each type's child is already declared.
+    for level in reversed(range(len(levels))):
+      name = 'Level{}'.format(level)
+      header.append('struct {} {{'.format(name))
+      for prop in levels[level]:
+        header.append('  {} {}{{}};'.format(prop.cpp_type, prop.name))
+      header.append('')
+      header.append('  RTTR_ENABLE();')
+      header.append('};')
+      header.append('')
+
+      source.append('static void')
+      source.append('fill ({} &msg, size_t items, size_t n, uint64_t seed)'.format(name))
+      source.append('{')
+      for prop in levels[level]:
+        if prop.kind == 'scalar':
+          source.append('  msg.{} = {};'.format(prop.name, prop.fill))
+        elif prop.kind == 'sequence':
+          source.append('  msg.{}.resize(n);'.format(prop.name))
+          source.append('  for (size_t i = 0; i < n; i++)')
+          source.append('    msg.{}[i] = static_cast<int64_t>(seed + i);'.format(prop.name))
+        elif prop.kind == 'any':
+          source.append('  for (size_t i = 0; i < n; i++) {')
+          source.append('    if (i % 2)')
+          source.append('      msg.{}["key-" + std::to_string(i)] = static_cast<int64_t>(seed + i);'.format(prop.name))
+          source.append('    else')
+          source.append('      msg.{}["key-" + std::to_string(i)] = std::to_string(seed + i);'.format(prop.name))
+          source.append('  }')
+        elif prop.kind == 'object':
+          source.append('  fill(msg.{}, 0, n, seed + 1);'.format(prop.name))
+        elif prop.kind == 'pointer':
+          source.append('  msg.{} = std::make_shared<{}>();'.format(prop.name, prop.child))
+          source.append('  fill(*msg.{}, 0, n, seed + 1);'.format(prop.name))
+        elif prop.kind == 'items':
+          source.append('  msg.{}.resize(items);'.format(prop.name))
+          source.append('  for (size_t i = 0; i < items; i++)')
+          source.append('    fill(msg.{}[i], 0, n, seed + i + 1);'.format(prop.name))
+      source.append('}')
+      source.append('')
+
+      registration.append('  {')
+      registration.append('    auto registration = ::rttr::registration::class_<{}::{}>("{}::{}");'.format(ns, name, shape['name'], name.lower()))
+      registration.append('    registration')
+      registration.append('      .constructor<>()(::rttr::policy::ctor::as_object)')
+      registration.append('      .constructor<>()(::rttr::policy::ctor::as_std_shared_ptr);')
+      for prop in levels[level]:
+        member = '&{}::{}::{}'.format(ns, name, prop.name)
+        metadata = []
+        if prop.defaulted:
+          metadata.append('::lldc::reflection::metadata::set_is_optional_with_default({})'.format(prop.default))
+        elif prop.optional:
+          metadata.append('::lldc::reflection::metadata::set_is_optional()')
+        if prop.access:
+          registration.append('    ::lldc::reflection::in_place_property(registration, "{}", {});'.format(
+            prop.name, ', '.join([member] + metadata)))
+        elif metadata:
+          registration.append('    registration.property("{}", {})({});'.format(prop.name, member, ', '.join(metadata)))
+        else:
+          registration.append('    registration.property("{}", {});'.format(prop.name, member))
+      registration.append('  }')
+      registration.append('')
+
+    header.append('using Message = Level0;')
+    header.append('')
+    header.append('/**')
+    header.append(' * @brief Fill the message with deterministic content: the root\'s \'items\'')
+    header.append(' * get that many elements and every other container gets \'n\'.')
+    header.append(' */')
+    header.append('void fill_message(Message &msg, size_t items, size_t n, uint64_t seed);')
+    header.append('}}; // {}'.format(ns))
+    header.append('')
+
+    source.append('void')
+    source.append('fill_message (Message &msg, size_t items, size_t n, uint64_t seed)')
+    source.append('{')
+    source.append('  fill(msg, items, n, seed);')
+    source.append('}')
+    source.append('}}; // {}'.format(ns))
+    source.append('')
+
+  header.append('// X(shape, has_items) for each generated shape.')
+  header.append('#define SYNTHETIC_SHAPES(X) \\')
+  header.append('  ' + ' \\\n  '.join(shape_list))
+  header.append('')
+
+  source.append('RTTR_REGISTRATION {')
+  source.extend(registration)
+  source.append('};')
+  source.append('')
+
+  return '\n'.join(header), '\n'.join(source)
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Generate synthetic message types for the benchmarks.')
+  parser.add_argument('--output-dir', required=True)
+  parser.add_argument('--shape', action='append', required=True, type=parse_shape)
+  args = parser.parse_args()
+
+  header, source = generate(args.shape)
+  with open(os.path.join(args.output_dir, 'synthetic.h'), 'w') as f:
+    f.write(header)
+  with open(os.path.join(args.output_dir, 'synthetic.cpp'), 'w') as f:
+    f.write(source)
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,208 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Pushes a corpus of synthetic messages through the converter in both
+ * directions, for each generated shape, while scaling either the number of
+ * objects in the root's 'items' vector or the size of every other container.
+ * Run with e.g. --benchmark_min_time=10s to push millions of messages.
+ * The batch variants convert the whole corpus with one batch call, spread
+ * over the batch worker pool, instead of one message at a time.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <synthetic.h>
+#include <common/uut.h>
+
+// The corpus holds distinct messages (by seed) adding up to about this much
+// converted output, within these bounds on the number of messages.
+static const size_t CORPUS_BYTES = 8 * 1024 * 1024;
+static const size_t CORPUS_MIN = 1;
+static const size_t CORPUS_MAX = 4096;
+
+template <typename M>
+static size_t
+make_corpus (benchmark::State &state, std::vector<M> &corpus)
+{
+  const size_t items = state.range(0);
+  const size_t n = state.range(1);
+
+  M first;
+  fill_message(first, items, n, 1);
+  uut_type temp = to_conversion(first);
+  const size_t bytes = std::max<size_t>(uut_size(temp), 1);
+  uut_unref(temp);
+
+  corpus.resize(std::clamp(CORPUS_BYTES / bytes, CORPUS_MIN, CORPUS_MAX));
+  size_t total = 0;
+  for (size_t i = 0; i < corpus.size(); i++) {
+    fill_message(corpus[i], items, n, i + 1);
+    temp = to_conversion(corpus[i]);
+    total += uut_size(temp);
+    uut_unref(temp);
+  }
+  return total;
+}
+
+static void
+set_counters (benchmark::State &state, size_t messages, size_t bytes)
+{
+  state.SetItemsProcessed(state.iterations() * messages);
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["messages"] = benchmark::Counter(messages);
+  state.counters["messages/s"] = benchmark::Counter(state.iterations() * messages, benchmark::Counter::kIsRate);
+}
+
+template <typename M>
+static void
+BM_ThroughputTo (benchmark::State &state)
+{
+  std::vector<M> corpus;
+  const size_t bytes = make_corpus(state, corpus);
+
+  for (auto _ : state) {
+    for (auto &msg : corpus) {
+      uut_type temp = to_conversion(msg);
+      benchmark::DoNotOptimize(temp);
+      uut_unref(temp);
+    }
+  }
+
+  set_counters(state, corpus.size(), bytes);
+}
+
+template <typename M>
+static void
+BM_ThroughputFrom (benchmark::State &state)
+{
+  std::vector<uut_type> converted;
+  size_t bytes = 0;
+  {
+    std::vector<M> corpus;
+    bytes = make_corpus(state, corpus);
+    for (auto &msg : corpus)
+      converted.push_back(to_conversion(msg));
+  }
+
+  for (auto _ : state) {
+    for (auto &temp : converted) {
+      M output;
+      if (!from_conversion(temp, output)) {
+        state.SkipWithError("from conversion failed");
+        break;
+      }
+      benchmark::DoNotOptimize(output);
+    }
+  }
+
+  for (auto &temp : converted)
+    uut_unref(temp);
+  set_counters(state, converted.size(), bytes);
+}
+
+template <typename M>
+static void
+BM_ThroughputToBatch (benchmark::State &state)
+{
+  std::vector<M> corpus;
+  const size_t bytes = make_corpus(state, corpus);
+  const std::vector<::rttr::instance> objects(corpus.begin(), corpus.end());
+
+  for (auto _ : state) {
+    auto converted = to_batch_conversion(objects);
+    benchmark::DoNotOptimize(converted);
+    for (auto &temp : converted)
+      uut_unref(temp);
+  }
+
+  set_counters(state, corpus.size(), bytes);
+}
+
+template <typename M>
+static void
+BM_ThroughputFromBatch (benchmark::State &state)
+{
+  std::vector<uut_type> converted;
+  size_t bytes = 0;
+  {
+    std::vector<M> corpus;
+    bytes = make_corpus(state, corpus);
+    for (auto &msg : corpus)
+      converted.push_back(to_conversion(msg));
+  }
+
+  for (auto _ : state) {
+    std::vector<M> outputs(converted.size());
+    const std::vector<::rttr::instance> objects(outputs.begin(), outputs.end());
+    const auto success = from_batch_conversion(converted, objects);
+    if (std::find(success.begin(), success.end(), false) != success.end()) {
+      state.SkipWithError("from conversion failed");
+      break;
+    }
+    benchmark::DoNotOptimize(outputs);
+  }
+
+  for (auto &temp : converted)
+    uut_unref(temp);
+  set_counters(state, converted.size(), bytes);
+}
+
+/**
+ * @brief Register both directions for the shape: scaling the items vector
+ * (up to the order of 10 MB of objects per message) if the shape has one,
+ * and scaling the other containers.
+ */
+template <typename M>
+static void
+register_shape (const std::string &shape, bool has_items)
+{
+  const std::vector<std::string> directions = { "to", "from" };
+
+  for (const auto &direction : directions) {
+    auto function = (direction == "to") ? BM_ThroughputTo<M> : BM_ThroughputFrom<M>;
+    auto name = "throughput/" + shape + "/" + direction;
+
+    if (has_items) {
+      benchmark::RegisterBenchmark((name + "/items").c_str(), function)
+        ->ArgNames({"items", "n"})
+        ->ArgsProduct({{1, 64, 4096, 65536}, {4}})
+        ->Unit(benchmark::kMillisecond);
+    }
+
+    benchmark::RegisterBenchmark((name + "/containers").c_str(), function)
+      ->ArgNames({"items", "n"})
+      ->ArgsProduct({{has_items ? 1 : 0}, {4, 256, 16384}})
+      ->Unit(benchmark::kMillisecond);
+  }
+
+  benchmark::RegisterBenchmark(("throughput/" + shape + "/to/batch").c_str(), BM_ThroughputToBatch<M>)
+    ->ArgNames({"items", "n"})
+    ->ArgsProduct({{has_items ? 1 : 0}, {4, 256}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark(("throughput/" + shape + "/from/batch").c_str(), BM_ThroughputFromBatch<M>)
+    ->ArgNames({"items", "n"})
+    ->ArgsProduct({{has_items ? 1 : 0}, {4, 256}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+}
+
+int
+main (int argc, char **argv)
+{
+#define REGISTER_SHAPE(shape, has_items) \
+  register_shape<lldc::benchmarking::shape::Message>(#shape, has_items);
+  SYNTHETIC_SHAPES(REGISTER_SHAPE)
+#undef REGISTER_SHAPE
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Settings for the asynchronous converters (the *_async functions next to
+ * each "to" converter).  They take the object inside an rttr::variant,
+ * which holds its own copy (or the moved original), queue it for one of
+ * the background encoder threads and return at once, without locking.  The
+ * result comes back through a std::future or a completion callback, which
+ * runs on the encoder thread.  A variant holding a pointer or reference is
+ * not a snapshot: the object is read whenever its turn comes.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <lldc-reflection/api.h>
+
+namespace lldc::reflection::async {
+  /**
+   * @brief Set the number of background encoder threads (at least 1, and 1
+   * by default); conversions are queued on them in turn.  The current threads
+   * first convert everything already queued to them.  Do not call this while
+   * another thread may be queuing conversions.
+   */
+  LLDC_REFLECTION_API
+  void set_thread_count (size_t count);
+
+  LLDC_REFLECTION_API
+  size_t get_thread_count ();
+}; // lldc::reflection::async
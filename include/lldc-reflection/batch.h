@@ -0,0 +1,45 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Settings for the batch converters (the *_batch functions next to each
+ * converter).  A batch is spread over a pool of worker threads, with the
+ * calling thread taking part, and each thread stealing work from the others
+ * once it runs out, so uneven messages do not leave threads idle.  Each
+ * thread converts with its own ConversionContext.
+ *
+ * The same pool also splits very large arrays within a single message: an
+ * array with at least the split threshold of elements is written in chunks
+ * on several threads, and the chunks joined in order.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <lldc-reflection/api.h>
+
+namespace lldc::reflection::batch {
+  /**
+   * @brief Set the number of worker threads batches are spread over, besides
+   * the calling thread; with 0, batches run on the calling thread alone.  By
+   * default, there is one less than the number of hardware threads.  Waits
+   * for the current workers to finish their part of any running batch.
+   */
+  LLDC_REFLECTION_API
+  void set_thread_count (size_t count);
+
+  LLDC_REFLECTION_API
+  size_t get_thread_count ();
+
+  /**
+   * @brief Set the number of elements from which an array being written is
+   * split over the pool, e.g. 8192; 0, the default, never splits.  Arrays are
+   * only split when there are workers and the converter can join the chunks,
+   * and a pool not yet sized with set_thread_count is started on first use.
+   */
+  LLDC_REFLECTION_API
+  void set_array_split_threshold (size_t elements);
+
+  LLDC_REFLECTION_API
+  size_t get_array_split_threshold ();
+}; // lldc::reflection::batch
@@ -0,0 +1,98 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * A JSON value carried through conversions as it is, for members whose
+ * content is only known to (and decoded by) whoever handles it later, e.g.
+ * the payload of an envelope:
+ *
+ *   struct Envelope {
+ *     std::string kind;
+ *     lldc::reflection::Blob payload;
+ *     RTTR_ENABLE();
+ *   };
+ *
+ * A Blob member needs no metadata.  Unlike a std::string member registered
+ * with metadata::set_is_blob, which is turned into JSON text when read and
+ * parsed again when written, a Blob keeps what the converter read: the
+ * JsonNode (shared with the input tree, which must then be left unchanged)
+ * or the JSON text.  Writing it with the same converter splices that in as
+ * it is, and decode() converts it into its type once that is known, without
+ * another round through text.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <rttr/instance.h>
+#include <rttr/type>
+#include <lldc-reflection/api.h>
+#include <lldc-reflection/context.h>
+
+namespace lldc::reflection {
+
+namespace blob {
+  // What a Blob holds; each converter has its own kind.
+  struct Value;
+}; // blob
+
+class Blob {
+public:
+  Blob() = default;
+
+  /**
+   * @brief A Blob holding the JSON text, which is checked when written.
+   */
+  explicit Blob(std::string json);
+
+  explicit Blob(std::shared_ptr<const blob::Value> value) : _value(std::move(value)) {}
+
+  bool empty() const { return !_value; }
+
+  /**
+   * @brief The value as JSON text (empty if there is none).
+   */
+  std::string text() const;
+
+  /**
+   * @brief Convert the value into the object, straight from what was read.
+   * @return false if there is no value or it does not fit the object.
+   */
+  bool decode(::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread()) const;
+
+  const std::shared_ptr<const blob::Value>& value() const { return _value; }
+
+private:
+  std::shared_ptr<const blob::Value> _value;
+};
+
+namespace blob {
+  LLDC_REFLECTION_API
+  std::string text (const Blob &blob);
+
+  LLDC_REFLECTION_API
+  bool decode (const Blob &blob, ::rttr::instance obj, ConversionContext &context);
+
+  LLDC_REFLECTION_API
+  std::shared_ptr<const Value> from_text (std::string json);
+}; // blob
+
+inline
+Blob::Blob (std::string json) :
+  _value(blob::from_text(std::move(json)))
+{}
+
+inline std::string
+Blob::text () const
+{
+  return blob::text(*this);
+}
+
+inline bool
+Blob::decode (::rttr::instance obj, ConversionContext &context) const
+{
+  return blob::decode(*this, obj, context);
+}
+
+}; // lldc::reflection
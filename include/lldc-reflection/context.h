@@ -0,0 +1,75 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Concurrency contract for the converters:
+ *
+ *   1. Register all types (RTTR_[PLUGIN_]REGISTRATION) before converting
+ *      any of them; registration is not synchronized with conversion.
+ *   2. Any number of threads may then convert at the same time, as long as
+ *      no object, JsonNode or sio::message is written by one thread while
+ *      another uses it.  Sharing the source of a 'to' conversion between
+ *      threads is fine if nothing modifies it meanwhile.
+ *   3. A ConversionContext holds one thread's scratch buffers and caches and
+ *      must only be used by one thread at a time.  Each converter takes one
+ *      as its last argument, which defaults to the calling thread's own.
+ *
+ * The only process-wide state written during conversions is the cache of
+ * per-type plans, which takes a lock the first time each type is converted
+ * by a context; after that the context answers from its own cache.
+ */
+#pragma once
+
+#include <memory>
+
+#include <lldc-reflection/api.h>
+
+namespace lldc::reflection {
+
+namespace context {
+  struct State;
+
+  LLDC_REFLECTION_API
+  State* create ();
+
+  LLDC_REFLECTION_API
+  void destroy (State *state);
+}; // context
+
+/**
+ * @brief Scratch buffers and caches for conversions.  Create one per worker
+ * thread (or per task, if tasks move between threads) to have control over
+ * its lifetime, or let the converters use this_thread().  A context that is
+ * already busy, e.g. when a conversion is started from within a property's
+ * getter or setter, is left alone; the inner conversion uses a fresh one.
+ */
+class ConversionContext {
+public:
+  ConversionContext() : _state(context::create(), &context::destroy) {}
+
+  ConversionContext(const ConversionContext&) = delete;
+  ConversionContext& operator=(const ConversionContext&) = delete;
+
+  /**
+   * @brief The calling thread's own context, used by default.
+   */
+  static ConversionContext& this_thread();
+
+  context::State& state() { return *_state; }
+
+private:
+  std::unique_ptr<context::State, void (*)(context::State*)> _state;
+};
+
+namespace context {
+  LLDC_REFLECTION_API
+  ConversionContext& this_thread ();
+}; // context
+
+inline ConversionContext&
+ConversionContext::this_thread ()
+{
+  return context::this_thread();
+}
+
+}; // lldc::reflection
@@ -4,23 +4,120 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <lldc-reflection/api.h>
+#include <lldc-reflection/context.h>
 #include <lldc-reflection/registration.h>
+#include <lldc-reflection/result.h>
 #include <json-glib/json-glib.h>
 
 namespace lldc::reflection::converters {
   LLDC_REFLECTION_API
-  JsonNode* to_json_glib (::rttr::instance obj);
+  JsonNode* to_json_glib (::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
+
+  LLDC_REFLECTION_API
+  bool from_json_glib (JsonNode *node, ::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
 
+  /**
+   * @brief As above, also setting 'result' to what went wrong, if anything,
+   * and where (see lldc-reflection/result.h).  Bad input is rejected without
+   * throwing.
+   */
   LLDC_REFLECTION_API
-  bool from_json_glib (JsonNode *node, ::rttr::instance obj);
+  bool from_json_glib (JsonNode *node, ::rttr::instance obj, ConversionResult &result, ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief Queue the object held by the variant for to_json_glib on a
+   * background encoder thread (see lldc-reflection/async.h) and return at
+   * once.  The node (NULL if there was nothing to write) is the caller's to
+   * unref.
+   */
+  LLDC_REFLECTION_API
+  std::future<JsonNode*> to_json_glib_async (::rttr::variant obj);
+
+  /**
+   * @brief Receives an asynchronous conversion's node (or NULL, if it
+   * threw, along with the exception) on the encoder thread.  The node is
+   * the callback's to unref.
+   */
+  using json_glib_completion = std::function<void (JsonNode *node, std::exception_ptr error)>;
 
+  // As above, passing the result to 'done' instead.
+  LLDC_REFLECTION_API
+  void to_json_glib_async (::rttr::variant obj, json_glib_completion done);
+
+  /**
+   * @brief to_json_glib for each object, spread over the batch worker pool
+   * (see lldc-reflection/batch.h).  The nodes (each the caller's to unref,
+   * NULL where there was nothing to write) are in the order of the objects.
+   * @throws exceptions::RequiredMemberSerializationFailure for the first
+   * object that failed that way, having unreffed the other nodes
+   */
+  LLDC_REFLECTION_API
+  std::vector<JsonNode*> to_json_glib_batch (std::span<const ::rttr::instance> objects);
+
+  /**
+   * @brief from_json_glib for each node, into the object at the same index,
+   * spread over the batch worker pool.  No two of the nodes may share any
+   * part of their trees.
+   * @return whether each succeeded, in order.
+   * @throws exceptions::BatchSizeMismatch
+   */
+  LLDC_REFLECTION_API
+  std::vector<bool> from_json_glib_batch (std::span<JsonNode* const> nodes, std::span<const ::rttr::instance> objects);
+
+  /**
+   * JSON text through json-glib.  Each thread keeps its own JsonParser and
+   * JsonGenerator, and reuses them for every call.
+   */
   namespace json_glib {
+    // How to_json lays out the text: indented over several lines, or with no
+    // whitespace at all (about half the size).
+    enum class Layout {
+      pretty,
+      compact
+    };
+
+    /**
+     * @brief Convert the object to JSON text (pretty), or an empty string if
+     * there was nothing to write.
+     */
+    LLDC_REFLECTION_API
+    std::string to_json (::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
+
+    LLDC_REFLECTION_API
+    std::string to_json (::rttr::instance obj, Layout layout, ConversionContext &context = ConversionContext::this_thread());
+
+    /**
+     * @brief As above, writing into 'out', which is cleared first; reusing
+     * the same string for each message saves reallocating its buffer.
+     * @return false if there was nothing to write ('out' is left empty).
+     */
+    LLDC_REFLECTION_API
+    bool to_json (::rttr::instance obj, std::string &out, Layout layout = Layout::pretty, ConversionContext &context = ConversionContext::this_thread());
+
+    // As above, for a GString.
+    LLDC_REFLECTION_API
+    bool to_json (::rttr::instance obj, GString *out, Layout layout = Layout::pretty, ConversionContext &context = ConversionContext::this_thread());
+
+    /**
+     * @brief Parse the JSON text, which must be an object, into obj.
+     * @return false if the text is malformed or does not fit obj.
+     */
     LLDC_REFLECTION_API
-    std::string to_json (::rttr::instance obj);
+    bool from_json (std::string_view json_str, ::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
 
+    // As above, for text received as bytes.
     LLDC_REFLECTION_API
-    bool from_json (const std::string &json_str, ::rttr::instance obj);
+    bool from_json (std::span<const std::byte> bytes, ::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
   };
 
 }; // lldc::reflection::converters
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Native JSON converter.  Unlike the json-glib converter, this writes the
+ * JSON text directly from the registered properties, and reads it directly
+ * into them, without building a document tree in between.  The optional, default and blob handling is the
+ * same as the other converters; the output is compact (no whitespace).
+ *
+ * Each function takes the ConversionContext to use last, which defaults to
+ * the calling thread's; see lldc-reflection/context.h.
+ */
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lldc-reflection/api.h>
+#include <lldc-reflection/context.h>
+#include <lldc-reflection/registration.h>
+#include <lldc-reflection/result.h>
+
+namespace lldc::reflection::converters::json {
+  /**
+   * @brief Receives the JSON text in order, in one or more chunks.
+   */
+  using sink = std::function<void (std::string_view chunk)>;
+
+  /**
+   * @brief Convert the object to JSON text, or an empty string if there was
+   * nothing to write.
+   * @throws exceptions::RequiredMemberSerializationFailure
+   */
+  LLDC_REFLECTION_API
+  std::string to_json (::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief As above, writing into 'out', which is cleared first; reusing the
+   * same string for each message saves reallocating its buffer.
+   * @return false if there was nothing to write ('out' is left empty).
+   */
+  LLDC_REFLECTION_API
+  bool to_json (::rttr::instance obj, std::string &out, ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief As above, passing the text to 'out' as it is completed rather than
+   * holding all of it.  If an exception is thrown, 'out' may already have
+   * received the start of the document.
+   */
+  LLDC_REFLECTION_API
+  bool to_json (::rttr::instance obj, const sink &out, ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief Queue the object held by the variant for to_json on a background
+   * encoder thread (see lldc-reflection/async.h) and return at once.
+   * @return the text, or the exception to_json threw.
+   */
+  LLDC_REFLECTION_API
+  std::future<std::string> to_json_async (::rttr::variant object);
+
+  /**
+   * @brief Receives an asynchronous conversion's result, or the exception it
+   * threw, on the encoder thread.
+   */
+  using completion = std::function<void (std::string text, std::exception_ptr error)>;
+
+  // As above, passing the result to 'done' instead.
+  LLDC_REFLECTION_API
+  void to_json_async (::rttr::variant object, completion done);
+
+  /**
+   * @brief Read the JSON text, which must be an object, into the registered
+   * properties of obj in a single pass.
+   * @return false if the text is malformed or a required member is missing,
+   * in which case obj may have been partly updated already.
+   */
+  LLDC_REFLECTION_API
+  bool from_json (std::string_view text, ::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
+
+  // As above, for text received as bytes.
+  LLDC_REFLECTION_API
+  bool from_json (std::span<const std::byte> bytes, ::rttr::instance obj, ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief As above, also setting 'result' to what went wrong, if anything,
+   * and where (see lldc-reflection/result.h).  Bad input is rejected without
+   * throwing.
+   */
+  LLDC_REFLECTION_API
+  bool from_json (std::string_view text, ::rttr::instance obj, ConversionResult &result, ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief to_json for each object, spread over the batch worker pool (see
+   * lldc-reflection/batch.h).  The results are in the order of the objects.
+   * @throws exceptions::RequiredMemberSerializationFailure for the first
+   * object that failed that way (after the whole batch has been converted)
+   */
+  LLDC_REFLECTION_API
+  std::vector<std::string> to_json_batch (std::span<const ::rttr::instance> objects);
+
+  /**
+   * @brief from_json for each text, into the object at the same index,
+   * spread over the batch worker pool.
+   * @return whether each succeeded, in order.
+   * @throws exceptions::BatchSizeMismatch
+   */
+  LLDC_REFLECTION_API
+  std::vector<bool> from_json_batch (std::span<const std::string_view> texts, std::span<const ::rttr::instance> objects);
+
+  LLDC_REFLECTION_API
+  std::vector<bool> from_json_batch (std::span<const std::string> texts, std::span<const ::rttr::instance> objects);
+}; // lldc::reflection::converters::json
@@ -4,8 +4,16 @@
  */
 #pragma once
 
+#include <exception>
+#include <functional>
+#include <future>
+#include <span>
+#include <vector>
+
 #include <lldc-reflection/api.h>
+#include <lldc-reflection/context.h>
 #include <lldc-reflection/registration.h>
+#include <lldc-reflection/result.h>
 #include <sio_message.h>
 
 namespace lldc::reflection::converters {
@@ -14,20 +22,111 @@ namespace lldc::reflection::converters {
  * @brief Convert the #object to an sio::message::ptr instance
  *
  * @param object the registered reference object
+ * @param context scratch buffers and caches to use (see lldc-reflection/context.h)
  * @return sio::message::ptr the resulting message, if successfully converted
  */
 LLDC_REFLECTION_API
-::sio::message::ptr to_socket_io (::rttr::instance object);
+::sio::message::ptr to_socket_io (::rttr::instance object, ConversionContext &context = ConversionContext::this_thread());
 
 /**
  * @brief Convert the #message to its RTTR registered #object
  *
  * @param message the reference message
  * @param object the resulting parsed object
+ * @param context scratch buffers and caches to use (see lldc-reflection/context.h)
  * @return true if parsing was successful
  * @return false if prasing wass unsuccessful
  */
 LLDC_REFLECTION_API
-bool from_socket_io (const ::sio::message::ptr message, ::rttr::instance object);
+bool from_socket_io (const ::sio::message::ptr &message, ::rttr::instance object, ConversionContext &context = ConversionContext::this_thread());
+
+/**
+ * @brief As above, also reporting what went wrong, if anything, without
+ * throwing for bad input
+ *
+ * @param message the reference message
+ * @param object the resulting parsed object
+ * @param result set to the failure and the path to where it was found
+ * (see lldc-reflection/result.h)
+ * @param context scratch buffers and caches to use (see lldc-reflection/context.h)
+ * @return true if parsing was successful
+ */
+LLDC_REFLECTION_API
+bool from_socket_io (const ::sio::message::ptr &message, ::rttr::instance object, ConversionResult &result, ConversionContext &context = ConversionContext::this_thread());
+
+/**
+ * @brief As above, consuming the #message: its strings and binary buffers
+ * are moved into the #object rather than copied, so only pass a message that
+ * will not be used again (e.g., one just received).  Parts of the message
+ * also held elsewhere (by another sio::message::ptr) are copied as usual.
+ *
+ * @param message the reference message, taken over and left empty
+ * @param object the resulting parsed object
+ * @param context scratch buffers and caches to use (see lldc-reflection/context.h)
+ * @return true if parsing was successful
+ */
+LLDC_REFLECTION_API
+bool from_socket_io (::sio::message::ptr &&message, ::rttr::instance object, ConversionContext &context = ConversionContext::this_thread());
+
+/**
+ * @brief As above, consuming the #message, also reporting what went wrong
+ *
+ * @param message the reference message, taken over and left empty
+ * @param object the resulting parsed object
+ * @param result set to the failure and the path to where it was found
+ * @param context scratch buffers and caches to use (see lldc-reflection/context.h)
+ * @return true if parsing was successful
+ */
+LLDC_REFLECTION_API
+bool from_socket_io (::sio::message::ptr &&message, ::rttr::instance object, ConversionResult &result, ConversionContext &context = ConversionContext::this_thread());
+
+/**
+ * @brief Queue the #object for to_socket_io on a background encoder thread
+ * (see lldc-reflection/async.h) and return at once
+ *
+ * @param object the variant holding the registered reference object
+ * @return the resulting message, or the exception to_socket_io threw
+ */
+LLDC_REFLECTION_API
+std::future<::sio::message::ptr> to_socket_io_async (::rttr::variant object);
+
+/**
+ * @brief Receives an asynchronous conversion's message (or nullptr, if it
+ * threw, along with the exception) on the encoder thread.
+ */
+using socket_io_completion = std::function<void (::sio::message::ptr message, std::exception_ptr error)>;
+
+/**
+ * @brief As above, passing the result to #done instead
+ *
+ * @param object the variant holding the registered reference object
+ * @param done called with the result on the encoder thread
+ */
+LLDC_REFLECTION_API
+void to_socket_io_async (::rttr::variant object, socket_io_completion done);
+
+/**
+ * @brief Convert each of the #objects as to_socket_io would, spread over the
+ * batch worker pool (see lldc-reflection/batch.h)
+ *
+ * @param objects the registered reference objects
+ * @return the resulting messages, in the order of the #objects
+ * @throws exceptions::RequiredMemberSerializationFailure for the first object
+ * that failed that way
+ */
+LLDC_REFLECTION_API
+std::vector<::sio::message::ptr> to_socket_io_batch (std::span<const ::rttr::instance> objects);
+
+/**
+ * @brief Convert each of the #messages as from_socket_io would, into the
+ * object at the same index, spread over the batch worker pool
+ *
+ * @param messages the reference messages
+ * @param objects the resulting parsed objects
+ * @return whether parsing each was successful, in order
+ * @throws exceptions::BatchSizeMismatch
+ */
+LLDC_REFLECTION_API
+std::vector<bool> from_socket_io_batch (std::span<const ::sio::message::ptr> messages, std::span<const ::rttr::instance> objects);
 
 }; // lldc::rttr::converters
\ No newline at end of file
@@ -23,6 +23,15 @@ struct ReferenceValueComparisonMismatch : public std::exception {
   }
 };
 
+/**
+ * @brief The spans given to a batch converter differ in length.
+ */
+struct BatchSizeMismatch : public std::exception {
+  const char* what() const throw () {
+    return "batch inputs and objects differ in number";
+  }
+};
+
 struct RequiredMemberSerializationFailure : public std::exception {
   RequiredMemberSerializationFailure(const std::string& member_name) : _member_name(member_name) {}
 
@@ -10,7 +10,69 @@
 #include <lldc-reflection/api.h>
 #include <rttr/registration>
 
+#include <functional>
+#include <memory>
+
 namespace lldc::reflection::metadata {
+  /**
+   * @brief Direct access to a data member of a registered type.  See in_place_property
+   * (lldc-reflection/registration.h), which registers a property with one.
+   */
+  class MemberAccess {
+  public:
+    virtual ~MemberAccess() = default;
+
+    /**
+     * @brief A variant holding a std::reference_wrapper to the member of the given object,
+     * or an invalid variant if the object is not an instance of the declaring type.
+     */
+    virtual ::rttr::variant reference(const ::rttr::instance &obj) const = 0;
+
+    /**
+     * @brief The address of the member of the given object (or nullptr, as above), which
+     * holds a value of member_type().  Lets the converters read and write scalar members
+     * without boxing them in a variant.
+     */
+    virtual void* address(const ::rttr::instance &) const { return nullptr; }
+
+    virtual ::rttr::type member_type() const { return ::rttr::type::get<void>(); }
+
+    /**
+     * @brief The class declaring the member.  The converters only use an access whose
+     * member_type() and declaring_type() match the property it is registered on.
+     */
+    virtual ::rttr::type declaring_type() const { return ::rttr::type::get<void>(); }
+  };
+
+  template <typename C, typename M>
+  class MemberAccessImpl : public MemberAccess {
+  public:
+    explicit MemberAccessImpl(M C::* member) : _member(member) {}
+
+    ::rttr::variant reference(const ::rttr::instance &obj) const override {
+      C *target = obj.try_convert<C>();
+      if (!target)
+        return ::rttr::variant();
+      return std::ref(target->*_member);
+    }
+
+    void* address(const ::rttr::instance &obj) const override {
+      C *target = obj.try_convert<C>();
+      return (target) ? &(target->*_member) : nullptr;
+    }
+
+    ::rttr::type member_type() const override {
+      return ::rttr::type::get<M>();
+    }
+
+    ::rttr::type declaring_type() const override {
+      return ::rttr::type::get<C>();
+    }
+
+  private:
+    M C::* _member;
+  };
+
   /**
    * @brief Properties marked as optional will have this metadata set in their RTTR registration.
    * "To" Behavior:
@@ -59,4 +121,19 @@ namespace lldc::reflection::metadata {
    */
   LLDC_REFLECTION_API
   ::rttr::detail::metadata set_is_blob();
+
+  namespace detail {
+    /**
+     * @brief The metadata in_place_property attaches to the property it registers.  Not to be
+     * used directly: nothing ties the access to the property it is given to, so it could name
+     * another member of the same type.
+     */
+    LLDC_REFLECTION_API
+    ::rttr::detail::metadata set_member_access(std::shared_ptr<const MemberAccess> access);
+
+    template <typename C, typename M>
+    ::rttr::detail::metadata set_member_access(M C::* member) {
+      return set_member_access(std::make_shared<MemberAccessImpl<C, M>>(member));
+    }
+  };
 };
@@ -22,9 +22,39 @@
  *   RTTR_REGISTRATION {
  *     // same contents as above.
  *   };
+ *
+ * Data members can instead be registered with in_place_property (below),
+ * which lets the converters read and write them directly.
  */
 #pragma once
 
 #include <rttr/registration>
 #include <lldc-reflection/metadata/metadata.h>
 #include <lldc-reflection/exceptions/exceptions.h>
+
+#include <utility>
+
+namespace lldc::reflection {
+  /**
+   * @brief Register the data member as a property, as .property(name, member) does, also
+   * giving the converters direct access to it: containers and nested objects are read in
+   * place rather than through the copy RTTR makes of a property's value, and arithmetic,
+   * enumeration and std::string members are read and written without a variant.  Further
+   * metadata and policies are passed after the member:
+   *
+   *   auto message = ::rttr::registration::class_<Message>("message");
+   *   lldc::reflection::in_place_property(message, "body", &Message::body);
+   *   lldc::reflection::in_place_property(message, "count", &Message::count,
+   *     lldc::reflection::metadata::set_is_optional());
+   *
+   * Members registered with ::rttr::policy::prop::as_reference_wrapper are already read in place.
+   * @return the registration, as returned by RTTR's own .property(...)(...)
+   */
+  template <typename Registration, typename C, typename M, typename... Args>
+  auto
+  in_place_property (Registration &registration, ::rttr::string_view name, M C::* member, Args &&...args)
+  {
+    return registration.property(name, member)(
+      metadata::detail::set_member_access(member), std::forward<Args>(args)...);
+  }
+};
@@ -0,0 +1,53 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * The outcome of a "from" conversion, for the converter overloads that
+ * report what went wrong rather than only returning false.  Failures found
+ * while reading are reported without throwing, so rejecting a flood of bad
+ * messages costs no more than reading them.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace lldc::reflection {
+
+enum class ConversionError {
+  none,
+
+  // The input is not an object (e.g., null, or an array).
+  not_an_object,
+
+  // The JSON text is not well-formed, or nests too deep.
+  malformed,
+
+  // A member registered as required is missing.
+  missing_member,
+
+  // Something the conversion called threw, e.g. a property's setter.
+  exception,
+};
+
+struct ConversionResult {
+  ConversionError error = ConversionError::none;
+
+  /**
+   * @brief Where the failure was found: the members and array indices
+   * leading to it from the root, e.g. "/body/data[3]/value", or empty if
+   * it concerns the root itself.  For a missing member, it ends with the
+   * missing member's name.
+   */
+  std::string path;
+
+  /**
+   * @brief How many members of the input, over all of its objects, matched
+   * no registered property.  They are skipped, which is not a failure.
+   */
+  size_t unknown_members = 0;
+
+  explicit operator bool() const { return error == ConversionError::none; }
+};
+
+}; // lldc::reflection
@@ -0,0 +1,101 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Opt-in conversion statistics: for each message type and converter, the
+ * number of conversions, how many failed, the bytes they produced or
+ * consumed and a histogram of how long they took.  Each thread records into
+ * its own shard without locking; reading the statistics adds the shards up.
+ *
+ * "Bytes" are the length of the text for the JSON text converters and the
+ * string and blob payload for the others (JsonNode, sio::message), which
+ * have no encoded length of their own.
+ *
+ * With a sample interval of N, only one in N conversions on each thread is
+ * recorded, counting N times, so the figures are estimates of the totals.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <lldc-reflection/api.h>
+
+namespace lldc::reflection::stats {
+  enum class Converter : uint8_t {
+    to_json_glib,
+    from_json_glib,
+    to_socket_io,
+    from_socket_io,
+    to_json,
+    from_json,
+  };
+
+  LLDC_REFLECTION_API
+  const char* converter_name (Converter converter);
+
+  /**
+   * @brief Latency buckets double from 512 ns: bucket i counts conversions
+   * taking less than 512 << i nanoseconds (and at least the bucket below);
+   * the last one counts everything slower.
+   */
+  static constexpr size_t LATENCY_BUCKETS = 22;
+  static constexpr uint64_t LATENCY_FIRST_BOUND_NS = 512;
+
+  struct Entry {
+    std::string type;
+    Converter converter = Converter::to_json_glib;
+
+    uint64_t calls = 0;
+    uint64_t failures = 0;
+    uint64_t bytes = 0;
+    uint64_t latency_sum_ns = 0;
+    std::array<uint64_t, LATENCY_BUCKETS> latency {};
+  };
+
+  /**
+   * @brief Start (or stop) recording.  Off by default; while it is off, the
+   * converters only check this setting.
+   */
+  LLDC_REFLECTION_API
+  void set_enabled (bool enabled);
+
+  LLDC_REFLECTION_API
+  bool is_enabled ();
+
+  /**
+   * @brief Record one in 'interval' conversions on each thread (1, the
+   * default, records all of them; 0 is taken as 1).
+   */
+  LLDC_REFLECTION_API
+  void set_sample_interval (uint32_t interval);
+
+  LLDC_REFLECTION_API
+  uint32_t get_sample_interval ();
+
+  /**
+   * @brief The statistics recorded so far, one entry per type and converter
+   * used, ordered by type name and then converter.  Conversions finishing
+   * meanwhile may be partly included.
+   */
+  LLDC_REFLECTION_API
+  std::vector<Entry> snapshot ();
+
+  /**
+   * @brief The snapshot in the Prometheus text exposition format, as the
+   * lldc_reflection_conversions_total, _conversion_failures_total and
+   * _conversion_bytes_total counters and the lldc_reflection_conversion_seconds
+   * histogram, each labelled with 'type' and 'converter'.
+   */
+  LLDC_REFLECTION_API
+  std::string to_prometheus ();
+
+  /**
+   * @brief Zero everything recorded so far.
+   */
+  LLDC_REFLECTION_API
+  void reset ();
+}; // lldc::reflection::stats
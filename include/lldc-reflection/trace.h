@@ -0,0 +1,39 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Span tracing, for finding out where the time goes within a message: while
+ * a context is tracing, each conversion using it records a span for every
+ * object and every member written or read, with its type, duration and
+ * string and blob bytes.  stop() returns them in the Chrome trace event
+ * JSON format, which chrome://tracing and Perfetto (ui.perfetto.dev) open.
+ *
+ * This is a debugging aid: recording a span per member slows conversions
+ * down a lot.  A context that is not tracing only checks that it is not.
+ * Chunks of a large array written on other threads (see batch.h) are not
+ * recorded, and neither are conversions started from within a conversion.
+ */
+#pragma once
+
+#include <string>
+
+#include <lldc-reflection/api.h>
+#include <lldc-reflection/context.h>
+
+namespace lldc::reflection::trace {
+  /**
+   * @brief Start recording spans for conversions using the context,
+   * discarding any that were recorded before.  Like stop(), call it between
+   * the context's conversions, not from within one.
+   */
+  LLDC_REFLECTION_API
+  void start (ConversionContext &context = ConversionContext::this_thread());
+
+  /**
+   * @brief Stop recording, returning the spans as a Chrome trace (JSON
+   * object with a "traceEvents" array); empty if the context was not
+   * tracing.
+   */
+  LLDC_REFLECTION_API
+  std::string stop (ConversionContext &context = ConversionContext::this_thread());
+}; // lldc::reflection::trace
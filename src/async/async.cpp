@@ -0,0 +1,198 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lldc-reflection/async.h>
+
+#include "private/async/async.h"
+
+namespace lldc::reflection::async {
+
+/**
+ * @brief Vyukov's intrusive multi-producer, single-consumer queue.  The
+ * producers only exchange the head; the consumer owns the tail.  A pop can
+ * briefly miss a task whose producer has exchanged the head but not yet
+ * linked it, which is fine: the producer signals the consumer after that.
+ */
+class Queue {
+public:
+  Queue() : _head(&_stub), _tail(&_stub) {}
+
+  void push(Task *task) {
+    task->next.store(nullptr, std::memory_order_relaxed);
+    Task *previous = _head.exchange(task, std::memory_order_acq_rel);
+    previous->next.store(task, std::memory_order_release);
+  }
+
+  Task* pop() {
+    Task *tail = _tail;
+    Task *next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &_stub) {
+      if (!next)
+        return nullptr;
+      _tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+      _tail = next;
+      return tail;
+    }
+
+    if (tail != _head.load(std::memory_order_acquire))
+      return nullptr; // a push is half done.
+
+    // 'tail' is the last task; put the stub behind it so it can be taken.
+    push(&_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      _tail = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+private:
+  struct Stub : public Task {
+    void run() override {}
+  };
+
+  std::atomic<Task*> _head;
+  Task *_tail;
+  Stub _stub;
+};
+
+struct Encoder {
+  Queue queue;
+
+  // Bumped after each push (and to stop); the thread sleeps on it when idle.
+  std::atomic<uint32_t> signal = 0;
+  std::atomic<bool> stopping = false;
+  std::thread thread;
+
+  void run() {
+    while (true) {
+      if (drain())
+        continue;
+
+      const uint32_t seen = signal.load(std::memory_order_acquire);
+      if (drain())
+        continue;
+      if (stopping.load(std::memory_order_acquire))
+        return;
+      signal.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  // Run whatever is queued; false if there was nothing.
+  bool drain() {
+    bool ran = false;
+    while (Task *task = queue.pop()) {
+      std::unique_ptr<Task> owned(task);
+      owned->run();
+      ran = true;
+    }
+    return ran;
+  }
+
+  void wake() {
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+  }
+};
+
+class Encoders {
+public:
+  ~Encoders() {
+    stop();
+  }
+
+  void submit(std::unique_ptr<Task> task) {
+    if (!_started.load(std::memory_order_acquire))
+      start();
+
+    auto &encoder = *_encoders[_next.fetch_add(1, std::memory_order_relaxed) % _encoders.size()];
+    encoder.queue.push(task.release());
+    encoder.wake();
+  }
+
+  void resize(size_t count) {
+    std::lock_guard<std::mutex> guard(_lock);
+    stop_locked();
+    _count = std::max<size_t>(count, 1);
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _count;
+  }
+
+private:
+  void start() {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_started.load(std::memory_order_relaxed))
+      return;
+
+    for (size_t i = 0; i < _count; i++) {
+      auto encoder = std::make_unique<Encoder>();
+      encoder->thread = std::thread(&Encoder::run, encoder.get());
+      _encoders.push_back(std::move(encoder));
+    }
+    _started.store(true, std::memory_order_release);
+  }
+
+  void stop() {
+    std::lock_guard<std::mutex> guard(_lock);
+    stop_locked();
+  }
+
+  // Each thread finishes its queue before it stops.
+  void stop_locked() {
+    _started.store(false, std::memory_order_release);
+    for (auto &encoder : _encoders) {
+      encoder->stopping.store(true, std::memory_order_release);
+      encoder->wake();
+    }
+    for (auto &encoder : _encoders)
+      encoder->thread.join();
+    _encoders.clear();
+  }
+
+  std::mutex _lock;  // guards starting and stopping
+  std::atomic<bool> _started = false;
+  std::atomic<size_t> _next = 0;
+  std::vector<std::unique_ptr<Encoder>> _encoders;
+  size_t _count = 1;
+};
+
+static Encoders encoders;
+
+void
+submit (std::unique_ptr<Task> task)
+{
+  encoders.submit(std::move(task));
+}
+
+void
+set_thread_count (size_t count)
+{
+  encoders.resize(count);
+}
+
+size_t
+get_thread_count ()
+{
+  return encoders.size();
+}
+
+}; // lldc::reflection::async
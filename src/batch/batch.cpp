@@ -0,0 +1,296 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lldc-reflection/batch.h>
+
+#include "private/batch/batch.h"
+
+namespace lldc::reflection::batch {
+
+// The indices [begin, end) of a job still to be run by (or stolen from) one
+// participant.
+struct Share {
+  std::mutex lock;
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+struct Job {
+  Job(size_t count, size_t participants, size_t grain, const std::function<void (size_t)> &body) :
+    body(body),
+    grain(grain),
+    shares(participants),
+    remaining(count)
+  {
+    for (size_t k = 0; k < participants; k++) {
+      shares[k].begin = count * k / participants;
+      shares[k].end = count * (k + 1) / participants;
+    }
+  }
+
+  const std::function<void (size_t)> &body;
+  const size_t grain;
+  std::vector<Share> shares;
+
+  // The next share for a joining participant; the caller always has 0.
+  std::atomic<size_t> next_share = 1;
+
+  // The number of indices not yet run.
+  std::atomic<size_t> remaining;
+
+  // Guards the below, and signals 'finished' when 'remaining' reaches 0.
+  std::mutex lock;
+  std::condition_variable finished;
+  std::exception_ptr error;
+  size_t error_index = SIZE_MAX;
+};
+
+static bool
+take (Share &share, size_t grain, size_t &begin, size_t &end)
+{
+  std::lock_guard<std::mutex> guard(share.lock);
+  if (share.begin == share.end)
+    return false;
+
+  begin = share.begin;
+  end = std::min(share.end, begin + grain);
+  share.begin = end;
+  return true;
+}
+
+/**
+ * @brief Move the back half of the largest other share into the (empty)
+ * share 'mine'.  Returns false if there was nothing left to steal.  Only one
+ * share is locked at a time; indices in transit are in neither share, which
+ * is fine since they are run by the thief either way.
+ */
+static bool
+steal (Job &job, size_t mine)
+{
+  const size_t participants = job.shares.size();
+
+  while (true) {
+    size_t victim = participants;
+    size_t largest = 0;
+    for (size_t k = 0; k < participants; k++) {
+      if (k == mine)
+        continue;
+      std::lock_guard<std::mutex> guard(job.shares[k].lock);
+      const size_t size = job.shares[k].end - job.shares[k].begin;
+      if (size > largest) {
+        largest = size;
+        victim = k;
+      }
+    }
+    if (victim == participants)
+      return false;
+
+    size_t begin, end;
+    {
+      auto &share = job.shares[victim];
+      std::lock_guard<std::mutex> guard(share.lock);
+      const size_t size = share.end - share.begin;
+      if (size == 0)
+        continue; // emptied in the meantime; look again.
+      end = share.end;
+      begin = end - (size + 1) / 2;
+      share.end = begin;
+    }
+
+    auto &share = job.shares[mine];
+    std::lock_guard<std::mutex> guard(share.lock);
+    share.begin = begin;
+    share.end = end;
+    return true;
+  }
+}
+
+static void
+participate (Job &job, size_t mine)
+{
+  size_t begin, end;
+
+  while (true) {
+    if (!take(job.shares[mine], job.grain, begin, end)) {
+      if (!steal(job, mine))
+        break;
+      continue;
+    }
+
+    for (size_t i = begin; i < end; i++) {
+      try {
+        job.body(i);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> guard(job.lock);
+        if (i < job.error_index) {
+          job.error_index = i;
+          job.error = std::current_exception();
+        }
+      }
+    }
+
+    const size_t ran = end - begin;
+    if (job.remaining.fetch_sub(ran) == ran) {
+      std::lock_guard<std::mutex> guard(job.lock);
+      job.finished.notify_all();
+    }
+  }
+}
+
+class Pool {
+public:
+  ~Pool() {
+    resize(0);
+  }
+
+  void resize(size_t count) {
+    std::lock_guard<std::mutex> resizing(_resize_lock);
+    std::vector<std::thread> workers;
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _stopping = true;
+      workers.swap(_workers);
+    }
+    _wake.notify_all();
+    for (auto &worker : workers)
+      worker.join();
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _stopping = false;
+    _configured = true;
+    for (size_t i = 0; i < count; i++)
+      _workers.emplace_back(&Pool::work, this);
+  }
+
+  size_t size() {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      if (_configured)
+        return _workers.size();
+    }
+
+    // Not configured: one worker per hardware thread, besides the caller's.
+    const size_t hardware = std::thread::hardware_concurrency();
+    std::lock_guard<std::mutex> resizing(_resize_lock);
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_configured) {
+      _configured = true;
+      for (size_t i = 1; i < hardware; i++)
+        _workers.emplace_back(&Pool::work, this);
+    }
+    return _workers.size();
+  }
+
+  void submit(const std::shared_ptr<Job> &job) {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _jobs.push_back(job);
+    }
+    _wake.notify_all();
+  }
+
+  void retire(const std::shared_ptr<Job> &job) {
+    std::lock_guard<std::mutex> guard(_lock);
+    const auto it = std::find(_jobs.begin(), _jobs.end(), job);
+    if (it != _jobs.end())
+      _jobs.erase(it);
+  }
+
+private:
+  void work() {
+    std::unique_lock<std::mutex> lock(_lock);
+
+    while (true) {
+      _wake.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+      if (_stopping)
+        return;
+
+      const auto job = _jobs.front();
+      const size_t mine = job->next_share++;
+      if (mine + 1 >= job->shares.size())
+        _jobs.pop_front(); // every share is taken.
+      if (mine >= job->shares.size())
+        continue;
+
+      lock.unlock();
+      participate(*job, mine);
+      lock.lock();
+    }
+  }
+
+  std::mutex _resize_lock;
+  std::mutex _lock;  // guards the below
+  std::condition_variable _wake;
+  std::deque<std::shared_ptr<Job>> _jobs;
+  std::vector<std::thread> _workers;
+  bool _stopping = false;
+  bool _configured = false;
+};
+
+static Pool pool;
+static std::atomic<size_t> array_split_threshold = 0;
+
+void
+parallel_for (size_t count, const std::function<void (size_t)> &body, size_t grain)
+{
+  if (count == 0)
+    return;
+
+  grain = std::max<size_t>(grain, 1);
+  const size_t participants = std::min(pool.size() + 1, (count + grain - 1) / grain);
+  const auto job = std::make_shared<Job>(count, participants, grain, body);
+
+  if (participants > 1)
+    pool.submit(job);
+  participate(*job, 0);
+
+  {
+    std::unique_lock<std::mutex> lock(job->lock);
+    job->finished.wait(lock, [&job] { return job->remaining == 0; });
+  }
+
+  if (participants > 1)
+    pool.retire(job);
+  if (job->error)
+    std::rethrow_exception(job->error);
+}
+
+void
+set_thread_count (size_t count)
+{
+  pool.resize(count);
+}
+
+size_t
+get_thread_count ()
+{
+  return pool.size();
+}
+
+void
+set_array_split_threshold (size_t elements)
+{
+  array_split_threshold = elements;
+}
+
+size_t
+get_array_split_threshold ()
+{
+  return array_split_threshold;
+}
+
+}; // lldc::reflection::batch
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/json.h>
+
+#include "private/blob/blob.h"
+
+namespace lldc::reflection::blob {
+
+void
+TextValue::append_text (std::string &out) const
+{
+  out += text;
+}
+
+bool
+TextValue::decode (::rttr::instance obj, ConversionContext &context) const
+{
+  return ::lldc::reflection::converters::json::from_json(text, obj, context);
+}
+
+void
+BufferValue::append_text (std::string &out) const
+{
+  out += *buffer;
+}
+
+bool
+BufferValue::decode (::rttr::instance obj, ConversionContext &context) const
+{
+  return ::lldc::reflection::converters::json::from_json(*buffer, obj, context);
+}
+
+std::string
+text (const Blob &blob)
+{
+  std::string out;
+  if (blob.value())
+    blob.value()->append_text(out);
+  return out;
+}
+
+bool
+decode (const Blob &blob, ::rttr::instance obj, ConversionContext &context)
+{
+  return blob.value() && blob.value()->decode(obj, context);
+}
+
+std::shared_ptr<const Value>
+from_text (std::string json)
+{
+  return std::make_shared<TextValue>(std::move(json), false);
+}
+
+}; // lldc::reflection::blob
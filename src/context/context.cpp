@@ -0,0 +1,75 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/context.h>
+
+#include "private/context/context.h"
+
+namespace PLAN = lldc::reflection::plan;
+
+namespace lldc::reflection::context {
+
+// Scratch buffers larger than this are released after a conversion.
+static const size_t TRIM_CAPACITY = 256 * 1024;
+
+const PLAN::TypePlan&
+State::plan (const ::rttr::type &t)
+{
+  const auto id = t.get_id();
+  if (const auto it = plans.find(id); it != plans.cend())
+    return *it->second;
+
+  const auto &result = PLAN::get_type_plan(t);
+  plans.emplace(id, &result);
+  return result;
+}
+
+void
+State::trim ()
+{
+  if (buffer.capacity() > TRIM_CAPACITY)
+    std::string().swap(buffer);
+  if (key.capacity() > TRIM_CAPACITY)
+    std::string().swap(key);
+  if (scalar.string.capacity() > TRIM_CAPACITY)
+    std::string().swap(scalar.string);
+}
+
+Lease::Lease (ConversionContext &context)
+  : _state(&context.state())
+{
+  if (_state->busy) {
+    _temporary = std::make_unique<State>();
+    _state = _temporary.get();
+  }
+  _state->busy = true;
+}
+
+Lease::~Lease ()
+{
+  _state->busy = false;
+  _state->trim();
+}
+
+State*
+create ()
+{
+  return new State();
+}
+
+void
+destroy (State *state)
+{
+  delete state;
+}
+
+ConversionContext&
+this_thread ()
+{
+  thread_local ConversionContext instance;
+  return instance;
+}
+
+}; // lldc::reflection::context
@@ -0,0 +1,32 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/json-glib.h>
+
+#include "private/async/async.h"
+
+namespace ASYNC = lldc::reflection::async;
+
+namespace lldc::reflection::converters {
+
+static JsonNode*
+convert (::rttr::instance obj)
+{
+  return to_json_glib(obj);
+}
+
+std::future<JsonNode*>
+to_json_glib_async (::rttr::variant obj)
+{
+  return ASYNC::queue_conversion<JsonNode*>(std::move(obj), convert);
+}
+
+void
+to_json_glib_async (::rttr::variant obj, json_glib_completion done)
+{
+  ASYNC::queue_conversion<JsonNode*>(std::move(obj), convert, std::move(done));
+}
+
+}; // lldc::reflection::converters
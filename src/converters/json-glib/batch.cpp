@@ -0,0 +1,38 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/json-glib.h>
+#include <lldc-reflection/exceptions/exceptions.h>
+
+#include "private/batch/batch.h"
+
+namespace BATCH = lldc::reflection::batch;
+namespace EXCEPTIONS = lldc::reflection::exceptions;
+
+namespace lldc::reflection::converters {
+
+std::vector<JsonNode*>
+to_json_glib_batch (std::span<const ::rttr::instance> objects)
+{
+  return BATCH::run_conversions<JsonNode*>(objects.size(),
+    [&](size_t i) { return to_json_glib(objects[i]); },
+    [](JsonNode *node) {
+      if (node)
+        json_node_unref(node);
+    });
+}
+
+std::vector<bool>
+from_json_glib_batch (std::span<JsonNode* const> nodes, std::span<const ::rttr::instance> objects)
+{
+  if (nodes.size() != objects.size())
+    throw EXCEPTIONS::BatchSizeMismatch();
+
+  return BATCH::run_conversions<bool>(nodes.size(), [&](size_t i) {
+    return from_json_glib(nodes[i], objects[i]);
+  });
+}
+
+}; // lldc::reflection::converters
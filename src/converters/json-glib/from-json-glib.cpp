@@ -3,285 +3,169 @@
  *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
  *
  * This was modelled after the RapidJSON -based from_json example found
- * in the RTTR library.
+ * in the RTTR library.  The traversal itself now lives in the engine;
+ * this walks the JsonNode tree for it.
  */
 
+#include <memory>
+#include <string_view>
+#include <vector>
+
 #include <lldc-reflection/converters/json-glib.h>
-#include <lldc-reflection/metadata/metadata.h>
-#include <lldc-reflection/exceptions/exceptions.h>
 
-#include "private/associative-containers.h"
-#include "private/metadata/metadata.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/json-glib/json-glib.h"
+#include "private/stats/stats.h"
 #include "private/type/type.h"
 
-namespace AC = lldc::reflection::associative_containers;
-namespace METADATA = lldc::reflection::metadata;
-namespace EXCEPTIONS = lldc::reflection::exceptions;
+namespace CONTEXT = lldc::reflection::context;
+namespace ENGINE = lldc::reflection::engine;
+namespace STATS = lldc::reflection::stats;
 namespace TYPE = lldc::reflection::type;
 
 namespace lldc::reflection::converters {
 
-static void from_json_recursively (JsonObject *json_obj, ::rttr::instance obj2);
-static void write_array_recursively (JsonArray *arr, ::rttr::variant_sequential_view &view);
-static void write_associative_view_recursively (JsonArray *arr, ::rttr::variant_associative_view &view);
-static ::rttr::variant extract_basic_types (JsonNode *json_value, const ::rttr::type &t);
-static ::rttr::variant extract_value (JsonNode *json_value, const ::rttr::type &t);
-
-
-static void
-write_array_recursively (JsonArray *json_array, ::rttr::variant_sequential_view &view)
-{
-  guint json_array_size = json_array_get_length(json_array);
-  const ::rttr::type array_value_type = view.get_rank_type(1);
-
-  view.set_size(json_array_size);
-  for (guint i = 0; i < json_array_size; i++) {
-    auto element = json_array_get_element(json_array, i);
-    if (JSON_NODE_HOLDS_ARRAY(element)) {
-      auto sub_array_view = view.get_value(i).create_sequential_view();
-      write_array_recursively(json_node_get_array(element), sub_array_view);
-    }
-    else {
-      auto var = extract_value(element, array_value_type);
-      if (var.is_valid())
-        view.set_value(i, var);
+/**
+ * @brief Walks an existing JsonNode tree for the engine.
+ */
+class JsonGlibReader : public ENGINE::Reader {
+public:
+  JsonGlibReader(JsonNode *root, CONTEXT::State &state) :
+    ENGINE::Reader(state),
+    _current(root)
+  {}
+
+  ENGINE::NodeKind kind() const override {
+    switch (json_node_get_node_type(_current)) {
+      case JSON_NODE_OBJECT:  return ENGINE::NodeKind::object;
+      case JSON_NODE_ARRAY:   return ENGINE::NodeKind::array;
+      case JSON_NODE_VALUE:   return ENGINE::NodeKind::scalar;
+      default:                return ENGINE::NodeKind::null;
     }
   }
-}
 
-static void
-write_associative_view_recursively (JsonArray *json_array, ::rttr::variant_associative_view &view)
-{
-  guint json_array_size = json_array_get_length(json_array);
-  for (guint i = 0; i < json_array_size; i++) {
-    auto element = json_array_get_element (json_array, i);
-
-    if (JSON_NODE_HOLDS_OBJECT(element)) {
-      // Treat as: { 'key': <key>, 'value': <value>} view.
-      auto element_obj = json_node_dup_object (element);
-      auto key_mbr = json_object_get_member (element_obj, AC::KEY);
-      auto value_mbr = json_object_get_member (element_obj, AC::VALUE);
+  size_t size_hint() const override {
+    return (JSON_NODE_HOLDS_ARRAY(_current)) ? json_array_get_length(json_node_get_array(_current)) : 0;
+  }
 
-      if (key_mbr && value_mbr) {
-        auto key_var = extract_value (key_mbr, view.get_key_type());
-        auto value_var = extract_value (value_mbr, view.get_value_type());
+  void begin_object() override {
+    Frame frame {};
+    frame.container = _current;
+    json_object_iter_init(&frame.iter, json_node_get_object(_current));
+    _frames.push_back(frame);
+  }
 
-        if (key_var && value_var)
-          view.insert(key_var, value_var);
-      }
+  bool next_member(std::string_view &key) override {
+    auto &frame = _frames.back();
+    const gchar *name = nullptr;
+    JsonNode *member = nullptr;
 
-      json_object_unref(element_obj);
-    }
-    else {
-      // a "key-only" associative view (??)
-      ::rttr::variant extracted_value = extract_basic_types (element, view.get_key_type());
-      if (extracted_value && extracted_value.convert(view.get_key_type()))
-        view.insert(extracted_value);
+    if (json_object_iter_next(&frame.iter, &name, &member)) {
+      key = name;
+      _current = member;
+      return true;
     }
+
+    _current = frame.container;
+    _frames.pop_back();
+    return false;
   }
-}
 
-static ::rttr::variant
-extract_basic_types (JsonNode *json_value, const ::rttr::type &t)
-{
-  switch (json_node_get_value_type (json_value)) {
-    case G_TYPE_CHAR: {
-      auto ref = (char)*json_node_get_string(json_value);
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
-    }
+  void begin_array() override {
+    Frame frame {};
+    frame.container = _current;
+    frame.length = json_array_get_length(json_node_get_array(_current));
+    _frames.push_back(frame);
+  }
 
-    case G_TYPE_STRING: {
-      auto ref = std::string(json_node_get_string(json_value));
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
-    }
+  bool next_element() override {
+    auto &frame = _frames.back();
 
-    case G_TYPE_BOOLEAN: {
-      // Because the returned 'boolean' is typedef'd to int, we'll assert it
-      // to boolean here just for the sake of it.
-      auto ref = (json_node_get_boolean(json_value));
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
+    if (frame.index < frame.length) {
+      _current = json_array_get_element(json_node_get_array(frame.container), frame.index++);
+      return true;
     }
 
-    // JsonGLIB does not store these types.  Keep this commented
-    // for future reference.  They're stored as int/int64
-    // case G_TYPE_UINT:
-    // case G_TYPE_UINT64:
-
-    case G_TYPE_INT:
-    case G_TYPE_INT64: {
-      auto temp = json_node_get_int(json_value);
-      if (t == ::rttr::type::get<uint8_t>()) {
-        return static_cast<uint8_t> (temp);
-      }
-      else if (t == ::rttr::type::get<uint16_t>()) {
-        return static_cast<uint16_t> (temp);
-      }
-      else if (t == ::rttr::type::get<uint32_t>()) {
-        return static_cast<uint32_t> (temp);
-      }
-      else if (t == ::rttr::type::get<uint64_t>()) {
-        return static_cast<uint64_t> (temp);
-      }
-      else if (TYPE::is_any(t)) {
-        return std::any(temp);
-      }
-      return temp;
-    }
+    _current = frame.container;
+    _frames.pop_back();
+    return false;
+  }
 
-    case G_TYPE_FLOAT:
-    case G_TYPE_DOUBLE: {
-      auto ref = json_node_get_double(json_value);
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
-    }
+  bool read_scalar (TYPE::Scalar &value) override {
+    if (!JSON_NODE_HOLDS_VALUE(_current))
+      return false;
 
-    default:
-      break;
-  }
-  return ::rttr::variant();
-}
+    switch (json_node_get_value_type (_current)) {
+      case G_TYPE_CHAR:
+        value.kind = TYPE::ScalarKind::character;
+        value.string.assign(1, (char)*json_node_get_string(_current));
+        break;
 
-static ::rttr::variant
-extract_value (JsonNode *json_value, const ::rttr::type &t)
-{
-  ::rttr::variant extracted_value = extract_basic_types (json_value, t);
-  const bool could_convert = extracted_value.can_convert(t);
+      case G_TYPE_STRING:
+        value.kind = TYPE::ScalarKind::string;
+        value.string = json_node_get_string(_current);
+        break;
 
-  if (could_convert) {
-    extracted_value.convert(t);
-  }
-  else {
-    if (JSON_NODE_HOLDS_OBJECT(json_value)) {
-      auto local_value_t = t;
+      case G_TYPE_BOOLEAN:
+        value.kind = TYPE::ScalarKind::boolean;
+        value.boolean = json_node_get_boolean(_current);
+        break;
 
-      if (local_value_t.is_wrapper())
-        local_value_t = local_value_t.get_wrapped_type();
+      // JsonGLIB does not store these types.  Keep this commented
+      // for future reference.  They're stored as int/int64
+      // case G_TYPE_UINT:
+      // case G_TYPE_UINT64:
 
-      ::rttr::constructor ctor = local_value_t.get_constructor();
-      for (auto& item : local_value_t.get_raw_type().get_constructors()) {
-        if (item.get_instantiated_type() == t) {
-          ctor = item;
-          break;
-        }
-      }
+      case G_TYPE_INT:
+      case G_TYPE_INT64:
+        value.kind = TYPE::ScalarKind::integer;
+        value.integer = json_node_get_int(_current);
+        value.is_unsigned = false;
+        break;
 
-      if (ctor.is_valid())
-        extracted_value = ctor.invoke();
+      case G_TYPE_FLOAT:
+      case G_TYPE_DOUBLE:
+        value.kind = TYPE::ScalarKind::floating;
+        value.floating = json_node_get_double(_current);
+        break;
 
-      from_json_recursively (json_node_get_object(json_value), extracted_value);
+      default:
+        return false;
     }
+    return true;
   }
 
-  return extracted_value;
-}
-
-static void
-from_json_recursively (JsonObject *json_obj, ::rttr::instance obj2)
-{
-  ::rttr::instance obj = obj2.get_type().get_raw_type().is_wrapper() ? obj2.get_wrapped_instance() : obj2;
-  const auto prop_list = obj.get_derived_type().get_properties();
-
-  for (auto prop : prop_list) {
-    auto name = prop.get_name().data();
-    auto optional = METADATA::is_optional(prop, nullptr);
-    JsonNode *member = json_object_get_member(json_obj, name);
-    if (!member) {
-      if (optional)
-        continue; // not found, okay to skip
-      throw EXCEPTIONS::RequiredMemberSerializationFailure(name);
-    }
+  bool read_blob (std::string &out) override {
+    // Blobs are stored as the JSON itself; recover its (pretty-printed) string form.
+    auto json_str = json_to_string(_current, TRUE);
+    if (!json_str)
+      return false;
+    out = json_str;
+    g_free(json_str);
+    return true;
+  }
 
-    auto const value_t = prop.get_type();
-    ::rttr::variant var;
-
-    switch (json_node_get_node_type(member)) {
-      case JSON_NODE_ARRAY:
-      {
-        ::rttr::type local_value_t = value_t;
-        if (value_t.is_wrapper())
-          local_value_t = value_t.get_wrapped_type();
-
-        if (local_value_t.is_sequential_container()) {
-          auto json_array = json_node_get_array(member);
-          var = prop.get_value(obj);
-          auto view = var.create_sequential_view();
-          write_array_recursively(json_array, view);
-        }
-        else if (local_value_t.is_associative_container()) {
-          auto json_array = json_node_get_array(member);
-          var = prop.get_value(obj);
-          auto view = var.create_associative_view();
-          write_associative_view_recursively(json_array, view);
-        }
-        else if (METADATA::is_blob(prop)) {
-          auto json_str = json_to_string(member, TRUE);
-          if (json_str) {
-            var = std::string(json_str);
-            g_free(json_str);
-          }
-        }
-
-        prop.set_value(obj, var);
-        break;
-      }
-      case JSON_NODE_OBJECT:
-      {
-        if (METADATA::is_blob(prop)) {
-          auto json_str = json_to_string(member, TRUE);
-          if (json_str) {
-            var = std::string(json_str);
-            g_free(json_str);
-          }
-        }
-        else {
-          ::rttr::type local_value_t = value_t;
-          if (value_t.is_wrapper())
-            local_value_t = value_t.get_wrapped_type();
-
-          var = prop.get_value(obj);
-          if (local_value_t.is_pointer()) {
-            auto ctor = local_value_t.get_constructor();
-            for (auto& item : local_value_t.get_raw_type().get_constructors()) {
-              if (item.get_instantiated_type() == value_t) {
-                ctor = item;
-                break;
-              }
-            }
-            if (ctor.is_valid())
-              var = ctor.invoke();
-          }
-
-          from_json_recursively(json_node_get_object(member), var);
-        }
-        prop.set_value(obj, var);
-        break;
-      }
-      case JSON_NODE_NULL:
-      {
-        prop.set_value(obj, nullptr);
-        break;
-      }
-      default:
-      {
-        var = extract_basic_types (member, value_t);
-        // REMARK: conversion only works with "const type".
-        if (var.convert(value_t))
-          prop.set_value(obj, var);
-        break;
-      }
-    }
+  bool read_blob_value (Blob &out) override {
+    // Keep the node itself; it is only turned into text if asked to.
+    out = Blob(std::make_shared<JsonGlibBlobValue>(_current));
+    return true;
   }
-}
+
+private:
+  struct Frame {
+    JsonNode *container;
+    JsonObjectIter iter;
+    guint index;
+    guint length;
+  };
+
+  JsonNode *_current;
+  std::vector<Frame> _frames;
+};
 
 bool
-from_json_glib (JsonNode *node, ::rttr::instance obj)
+from_json_glib (JsonNode *node, ::rttr::instance obj, ConversionResult &result, ConversionContext &context)
 {
   // similar to to_json, we only assume the top-level
   // node contains a root object with properties in it:
@@ -290,36 +174,80 @@ from_json_glib (JsonNode *node, ::rttr::instance obj)
   //   "second_property": ...,
   //   etc.
   // }
-  bool success = false;
+  STATS::Sample sample(STATS::Converter::from_json_glib, obj);
+  result = ConversionResult();
 
   if (node && JSON_NODE_HOLDS_OBJECT(node)) {
     json_node_ref(node);
-    JsonObject *root = json_node_dup_object(node);
     try {
-      from_json_recursively(root, obj);
-      success = true;
+      CONTEXT::Lease lease(context);
+      JsonGlibReader reader(node, lease.state());
+      ENGINE::read(reader, obj);
+      result = std::move(reader.result);
+      if (result)
+        sample.succeeded(reader.bytes);
     }
     catch (...) {
-      // do nothing here; returning false
-      success = false;
+      result.error = ConversionError::exception;
     }
-    json_object_unref(root);
     json_node_unref(node);
   }
+  else {
+    result.error = ConversionError::not_an_object;
+  }
 
-  return success;
+  return static_cast<bool>(result);
+}
+
+bool
+from_json_glib (JsonNode *node, ::rttr::instance obj, ConversionContext &context)
+{
+  ConversionResult result;
+  return from_json_glib(node, obj, result, context);
 }
 
 namespace json_glib {
+  // The calling thread's parser.  Its root is taken from it before
+  // converting, so a from_json nested in the conversion (e.g., in a setter)
+  // can use it again.
+  static JsonParser*
+  thread_parser ()
+  {
+    struct Holder {
+      JsonParser *parser = json_parser_new();
+      ~Holder() { g_object_unref(parser); }
+    };
+    thread_local Holder holder;
+    return holder.parser;
+  }
+
   bool
-  from_json (const std::string &json_str, ::rttr::instance obj)
+  from_json (std::string_view json_str, ::rttr::instance obj, ConversionContext &context)
   {
-    GError* error = NULL;
-    auto node = json_from_string(json_str.c_str(), &error);
+    if (json_str.empty())
+      return false;
 
-    if (!error)
-      return from_json_glib(node, obj);
-    return false;
+    JsonParser *parser = thread_parser();
+    GError *error = NULL;
+
+    if (!json_parser_load_from_data(parser, json_str.data(), static_cast<gssize>(json_str.size()), &error)) {
+      g_clear_error(&error);
+      return false;
+    }
+
+    JsonNode *root = json_parser_steal_root(parser);
+    if (!root)
+      return false;
+
+    bool ok = from_json_glib(root, obj, context);
+    json_node_unref(root);
+    return ok;
+  }
+
+  bool
+  from_json (std::span<const std::byte> bytes, ::rttr::instance obj, ConversionContext &context)
+  {
+    return from_json(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()), obj, context);
   }
 }; // json_glib
 
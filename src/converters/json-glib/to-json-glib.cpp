@@ -3,328 +3,217 @@
  *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
  *
  * This was modelled after the RapidJSON -based to_json example
- * found in the RTTR library.
+ * found in the RTTR library.  The traversal itself now lives in the
+ * engine; this builds the JsonNode tree from its writer calls.
  */
 
-#include <string_view>
+#include <memory>
+#include <string>
+#include <vector>
 #include <json-glib/json-glib.h>
 
 #include <lldc-reflection/converters/json-glib.h>
-#include <lldc-reflection/metadata/metadata.h>
-#include <lldc-reflection/exceptions/exceptions.h>
 
-#include "private/associative-containers.h"
-#include "private/metadata/metadata.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/json-glib/json-glib.h"
+#include "private/stats/stats.h"
 #include "private/type/type.h"
 
-namespace AC = lldc::reflection::associative_containers;
-namespace METADATA = lldc::reflection::metadata;
+namespace CONTEXT = lldc::reflection::context;
+namespace ENGINE = lldc::reflection::engine;
+namespace STATS = lldc::reflection::stats;
 namespace TYPE = lldc::reflection::type;
 
 namespace lldc::reflection::converters {
 
-static bool to_json_recursive(const ::rttr::instance &obj2, JsonObject *object);
-static bool write_variant (const ::rttr::variant &var, JsonNode *node, bool optional = false);
-static bool attempt_write_fundamental_type (const ::rttr::type &t, const ::rttr::variant &var, JsonNode *node, bool optional = false);
-static bool write_array (const ::rttr::variant_sequential_view &view, JsonNode *node, bool optional = false);
-static bool write_associative_container (const ::rttr::variant_associative_view &view, JsonNode *node, bool optional = false);
-
-static bool
-attempt_write_fundamental_type (
-  const ::rttr::type &t,
-  const ::rttr::variant &var,
-  JsonNode *node,
-  bool optional)
-{
-  bool did_write = false;
-
-  // Json Number
-  if (t.is_arithmetic()) {
-    if (t == ::rttr::type::get<bool>()) {
-      json_node_init_boolean(node, var.to_bool());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<char>()) {
-      json_node_init_string(node, var.to_string().c_str());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int>()) {
-      json_node_init_int(node, var.to_int());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int8_t>()) {
-      json_node_init_int(node, var.to_int8());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int16_t>()) {
-      json_node_init_int(node, var.to_int16());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int32_t>()) {
-      json_node_init_int(node, var.to_int32());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int64_t>()) {
-      json_node_init_int(node, var.to_int64());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint8_t>()) {
-      json_node_init_int(node, static_cast<int64_t>(var.to_uint8()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint16_t>()) {
-      json_node_init_int(node, static_cast<int64_t>(var.to_uint16()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint32_t>()) {
-      json_node_init_int(node, static_cast<int64_t>(var.to_uint32()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint64_t>()) {
-      json_node_init_int(node, static_cast<int64_t>(var.to_uint64()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<float>() || t == ::rttr::type::get<double>()) {
-      json_node_init_double(node, var.to_double());
-      did_write = true;
-    }
-  }
-  // Enumeration as string
-  else if (t.is_enumeration()) {
-    // Attempt to serialize it as a string
-    bool ok = false;
-    auto result = var.to_string(&ok);
-
-    if (ok && !(optional && result.empty())) {
-      json_node_init_string (node, var.to_string().c_str());
-      did_write = true;
-    }
-    else {
-      // Attempt treating as a number
-      auto value = var.to_int64(&ok);
-      if (ok)
-        json_node_init_int(node, value);
-      else
-        json_node_init_object(node, nullptr);
-    }
-    did_write = true;
-  }
-  else if (t == ::rttr::type::get<std::string>()) {
-    auto result = var.to_string();
-
-    if (!(optional && result.empty())) {
-      if (METADATA::is_blob(t)) {
-        // Treat the string as JSON; store the serialized object into this node.
-        GError* error = NULL;
-        auto parsed = json_from_string(result.c_str(), &error);
-        if (!error) {
-          // get+init -> +1 ref count so when 'parsed' is unreffed, the count
-          // goes to 1, not zero.
-          auto parsed_obj = json_node_get_object(parsed);
-          json_node_init_object(node, parsed_obj);
-          json_node_unref(parsed);
-          did_write = true;
-        }
-      }
-      else {
-        json_node_init_string(node, result.c_str());
-        did_write = true;
-      }
-    }
+/**
+ * @brief Builds the JsonNode tree.  Each slot owns the node written into it
+ * until the slot is closed, when the node is handed to the enclosing object
+ * or array (or unreffed, if it is not kept).
+ */
+class JsonGlibWriter : public ENGINE::Writer {
+public:
+  explicit JsonGlibWriter(CONTEXT::State &state) : ENGINE::Writer(state) {
+    _stack.push_back(Entry{}); // root slot
   }
 
-  return did_write;
-}
-
-static bool
-write_array (const ::rttr::variant_sequential_view &view, JsonNode *node, bool optional)
-{
-  if (optional && view.get_size() == 0)
-    return false; // Don't bother serializing.
-
-  JsonArray *arr = json_array_new();
-
-  for (const auto& item : view) {
-    JsonNode *element = json_node_alloc();
-    if (write_variant(item, element, optional)) {
-      json_array_add_element(arr, element);
+  ~JsonGlibWriter() override {
+    for (auto &entry : _stack) {
+      if (entry.slot && entry.node)
+        json_node_unref(entry.node);
     }
   }
 
-  json_node_init_array(node, arr);
+  /**
+   * @brief Take ownership of the root node (or NULL if nothing was written).
+   */
+  JsonNode* take_root() {
+    JsonNode *root = _stack.front().node;
+    _stack.front().node = NULL;
+    return root;
+  }
 
-  // Already filtered out "empty" + "optional" = skip; creating an
-  // empty, required array is permissible.
-  return true;
-}
+  void begin_object() override {
+    auto node = json_node_new(JSON_NODE_OBJECT);
+    json_node_take_object(node, json_object_new());
+    set_value(node);
+    _stack.push_back(Entry{node, nullptr, false});
+  }
 
-static bool
-write_associative_container (const ::rttr::variant_associative_view &view, JsonNode *node, bool optional)
-{
-  if (optional && view.get_size() == 0)
-    return false; // Don't bother serializing.
-
-  JsonArray *arr = json_array_new();
-
-  // From the original source code comments:
-  //   "Dealing with keys = values containers like sets"
-  // However the RTTR docs say this method returns TRUE if the
-  // associative container is like a set, where it only contains
-  // keys.
-  if (view.is_key_only_type()) {
-    for (auto& item : view) {
-      JsonNode *element = json_node_alloc();
-      if (write_variant(item.first, element)) {
-        json_array_add_element(arr, element);
-      }
-    }
+  void end_object() override {
+    _stack.pop_back();
   }
-  else {
-    // Original is pretty clearly doing this:
-    //   vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
-    // [ {'key': <key>, 'value': <value>}, ... ]
-    for (auto& item : view) {
-      JsonNode *first = json_node_alloc();
-      JsonNode *second = json_node_alloc();
-
-      if (write_variant(item.first, first) && write_variant(item.second, second)) {
-        JsonNode* element = json_node_alloc();
-        JsonObject* element_obj = json_object_new();
-
-        json_node_init_object(element, element_obj);
-
-        json_object_set_member(element_obj, AC::KEY,   first);
-        json_object_set_member(element_obj, AC::VALUE, second);
-
-        json_array_add_element(arr, element);
-      }
-      else {
-        json_node_unref(first);
-        json_node_unref(second);
-      }
-    }
+
+  void begin_array() override {
+    auto node = json_node_new(JSON_NODE_ARRAY);
+    json_node_take_array(node, json_array_new());
+    set_value(node);
+    _stack.push_back(Entry{node, nullptr, false});
   }
 
-  // Inserting an empty associative container is okay because
-  // the container itself is !optional.
-  json_node_init_array(node, arr);
-  return true;
-}
+  void end_array() override {
+    _stack.pop_back();
+  }
 
-static bool
-write_variant (const ::rttr::variant &var, JsonNode *node, bool optional)
-{
-  bool did_write = false;
+  void begin_member(const std::string &key) override {
+    _stack.push_back(Entry{NULL, &key, true});
+  }
 
-  // Deal with wrapped type.
-  ::rttr::variant localVar = var;
-  ::rttr::type varType = var.get_type();
+  void end_member(bool keep) override {
+    const auto slot = close_slot();
+    if (keep && slot.node)
+      json_object_set_member(json_node_get_object(_stack.back().node), slot.key->c_str(), slot.node);
+    else if (slot.node)
+      json_node_unref(slot.node);
+  }
 
-  if (varType.is_wrapper()) {
-    varType = varType.get_wrapped_type();
-    localVar = localVar.extract_wrapped_value();
+  void begin_element() override {
+    _stack.push_back(Entry{NULL, nullptr, true});
   }
 
-  // If the varType is holding a std::any, it needs to be unpacked.
-  if (TYPE::is_any(varType)) {
-    did_write = write_variant(TYPE::extract_any_value(localVar), node, optional);
+  void end_element(bool keep) override {
+    const auto slot = close_slot();
+    if (keep && slot.node)
+      json_array_add_element(json_node_get_array(_stack.back().node), slot.node);
+    else if (slot.node)
+      json_node_unref(slot.node);
   }
-  else if (TYPE::is_fundamental(varType)) {
-    did_write = attempt_write_fundamental_type(varType, localVar, node, optional);
+
+  void reset_value() override {
+    while (!_stack.back().slot)
+      _stack.pop_back();
+    set_value(NULL);
   }
-  else if (localVar.is_sequential_container()) {
-    did_write = write_array(localVar.create_sequential_view(), node, optional);
+
+  void scalar(const TYPE::Scalar &value) override {
+    JsonNode *node = json_node_alloc();
+    switch (value.kind) {
+      case TYPE::ScalarKind::boolean:
+        json_node_init_boolean(node, value.boolean);
+        break;
+      case TYPE::ScalarKind::integer:
+        json_node_init_int(node, value.integer);
+        break;
+      case TYPE::ScalarKind::floating:
+        json_node_init_double(node, value.floating);
+        break;
+      default:
+        json_node_init_string(node, value.string.c_str());
+        break;
+    }
+    set_value(node);
   }
-  else if (localVar.is_associative_container()) {
-    did_write = write_associative_container(localVar.create_associative_view(), node, optional);
+
+  void null() override {
+    set_value(json_node_new(JSON_NODE_NULL));
   }
-  else {
-    // Not fundamental or a container -- treat as object.
-    auto json_object = json_object_new();
-    if (to_json_recursive(localVar, json_object)) {
-      json_node_set_object(node, json_object);
-      json_object = NULL;
-      did_write = true;
-    }
-    else if (!optional) {
-      // Source member is "empty" and required.
-      // If it's a pointer-type, represent it as a nullptr
-      // If not, represent it as an empty object.
-      if (varType.is_pointer()) {
-        json_node_init_null(node);
-      }
-      else {
-        json_node_init_object(node, json_object);
-        json_object = NULL;
-      }
-      did_write = true;
+
+  bool blob(const std::string &value) override {
+    // Treat the string as JSON; store the parsed node into this slot.
+    GError* error = NULL;
+    auto parsed = json_from_string(value.c_str(), &error);
+    if (error) {
+      g_error_free(error);
+      return false;
     }
+    if (!parsed)
+      return false;
 
-    if (json_object)
-      json_object_unref(json_object);
+    set_value(parsed);
+    return true;
   }
 
-  return did_write;
-}
+  bool blob_value(const Blob &value) override {
+    // A node read by from_json_glib goes in as a copy sharing its contents.
+    if (const auto read = dynamic_cast<const JsonGlibBlobValue*>(value.value().get())) {
+      set_value(json_node_copy(read->node));
+      return true;
+    }
+    return ENGINE::Writer::blob_value(value);
+  }
 
-static bool
-to_json_recursive(const ::rttr::instance &obj2, JsonObject *json_object)
-{
-  bool did_write = false;
-  ::rttr::instance obj = obj2.get_type().get_raw_type().is_wrapper() ? obj2.get_wrapped_instance() : obj2;
+  bool can_fork() const override {
+    return true;
+  }
 
-  auto prop_list = obj.get_derived_type().get_properties();
-  for (auto prop : prop_list)
-  {
-    const auto name = prop.get_name();
-    ::rttr::variant prop_value = prop.get_value(obj);
-    bool matches_default = false;
-    bool optional = METADATA::is_optional(prop, prop_value, &matches_default);
-
-    if (METADATA::is_no_serialize(prop)) {
-      did_write = true;
-      continue; // skip it.
-    }
+  std::unique_ptr<ENGINE::Writer> fork(CONTEXT::State &state) const override {
+    return std::make_unique<JsonGlibWriter>(state);
+  }
 
-    if (optional && matches_default) {
-      did_write = true;
-      continue; // By implication, skip it.
-    }
+  void join(ENGINE::Writer &fork) override {
+    // The fork's root is an array; its elements are this array's next ones.
+    JsonNode *root = static_cast<JsonGlibWriter&>(fork)._stack.front().node;
+    if (!root)
+      return;
+
+    JsonArray *from = json_node_get_array(root);
+    JsonArray *to = json_node_get_array(_stack.back().node);
+    const guint length = json_array_get_length(from);
+    for (guint i = 0; i < length; i++)
+      json_array_add_element(to, json_node_ref(json_array_get_element(from, i)));
+  }
 
-    if (optional && !prop_value) {
-      did_write = true;
-      continue; // null-like and it's optional; skip it.
-    }
+private:
+  struct Entry {
+    JsonNode *node = NULL;
+    const std::string *key = nullptr;
+    bool slot = true;
+  };
+
+  // Replace the innermost slot's node (there is always one on top when a
+  // value is written).
+  void set_value(JsonNode *node) {
+    auto &slot = _stack.back();
+    if (slot.node)
+      json_node_unref(slot.node);
+    slot.node = node;
+  }
 
-    JsonNode *prop_node = json_node_alloc();
-    if (write_variant(prop_value, prop_node, optional)) {
-      did_write = true;
-      json_object_set_member(json_object, name.data(), prop_node);
-    }
-    else {
-      json_node_unref(prop_node);
-      if (!optional) {
-        // Failed write and not optional -> error condition
-        throw exceptions::RequiredMemberSerializationFailure(name.to_string());
-      }
-    }
+  // Pop the innermost slot (and anything left open inside it); the caller
+  // takes over its node.
+  Entry close_slot() {
+    while (!_stack.back().slot)
+      _stack.pop_back();
+    const auto slot = _stack.back();
+    _stack.pop_back();
+    return slot;
   }
 
-  return did_write;
-}
+  std::vector<Entry> _stack;
+};
 
 JsonNode*
-to_json_glib (::rttr::instance rttr_obj) {
+to_json_glib (::rttr::instance rttr_obj, ConversionContext &context) {
   JsonNode* root = NULL;
+  STATS::Sample sample(STATS::Converter::to_json_glib, rttr_obj);
 
   if (rttr_obj.is_valid()) {
-    auto json_object = json_object_new();
-    if (to_json_recursive(rttr_obj, json_object)) {
-      root = json_node_new(JSON_NODE_OBJECT);
-      json_node_set_object(root, json_object);
-    }
-    else {
-      json_object_unref(json_object);
+    CONTEXT::Lease lease(context);
+    JsonGlibWriter writer(lease.state());
+    if (ENGINE::write(rttr_obj, writer)) {
+      root = writer.take_root();
+      sample.succeeded(writer.bytes);
     }
   }
 
@@ -332,16 +221,88 @@ to_json_glib (::rttr::instance rttr_obj) {
 }
 
 namespace json_glib {
-  std::string
-  to_json(::rttr::instance obj)
+  // Past this, the thread's text buffer is dropped after use rather than
+  // kept (as with the context's own buffers).
+  static const gsize TRIM_LENGTH = 256 * 1024;
+
+  // The calling thread's generator, and a buffer for text bound for a
+  // std::string.  Both are only used once the conversion itself is done,
+  // since a to_json nested in it (e.g., in a getter) uses them as well.
+  struct ThreadGenerator {
+    JsonGenerator *generator = json_generator_new();
+    GString *text = g_string_new(NULL);
+
+    ~ThreadGenerator() {
+      g_object_unref(generator);
+      g_string_free(text, TRUE);
+    }
+  };
+
+  static ThreadGenerator&
+  thread_generator ()
+  {
+    thread_local ThreadGenerator instance;
+    return instance;
+  }
+
+  // Append the tree's text to 'out', then unref the tree.
+  static void
+  generate (JsonNode *root, GString *out, Layout layout)
   {
-    JsonNode* root = to_json_glib(obj);
-    auto s = json_to_string (root, TRUE);
-    std::string out(s);
-    g_free(s);
+    JsonGenerator *generator = thread_generator().generator;
+    json_generator_set_pretty(generator, layout == Layout::pretty);
+    json_generator_set_root(generator, root);
+    json_generator_to_gstring(generator, out);
+    json_generator_set_root(generator, NULL);
     json_node_unref(root);
+  }
+
+  bool
+  to_json (::rttr::instance obj, GString *out, Layout layout, ConversionContext &context)
+  {
+    g_string_truncate(out, 0);
+
+    JsonNode *root = to_json_glib(obj, context);
+    if (!root)
+      return false;
+    generate(root, out, layout);
+    return true;
+  }
+
+  bool
+  to_json (::rttr::instance obj, std::string &out, Layout layout, ConversionContext &context)
+  {
+    out.clear();
+
+    JsonNode *root = to_json_glib(obj, context);
+    if (!root)
+      return false;
+
+    auto &thread = thread_generator();
+    g_string_truncate(thread.text, 0);
+    generate(root, thread.text, layout);
+
+    out.assign(thread.text->str, thread.text->len);
+    if (thread.text->allocated_len > TRIM_LENGTH) {
+      g_string_free(thread.text, TRUE);
+      thread.text = g_string_new(NULL);
+    }
+    return true;
+  }
+
+  std::string
+  to_json (::rttr::instance obj, Layout layout, ConversionContext &context)
+  {
+    std::string out;
+    to_json(obj, out, layout, context);
     return out;
   }
+
+  std::string
+  to_json (::rttr::instance obj, ConversionContext &context)
+  {
+    return to_json(obj, Layout::pretty, context);
+  }
 }; // json_glib
 
-}; // lldc::reflection::converters
\ No newline at end of file
+}; // lldc::reflection::converters
@@ -0,0 +1,32 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/json.h>
+
+#include "private/async/async.h"
+
+namespace ASYNC = lldc::reflection::async;
+
+namespace lldc::reflection::converters::json {
+
+static std::string
+convert (::rttr::instance obj)
+{
+  return to_json(obj);
+}
+
+std::future<std::string>
+to_json_async (::rttr::variant object)
+{
+  return ASYNC::queue_conversion<std::string>(std::move(object), convert);
+}
+
+void
+to_json_async (::rttr::variant object, completion done)
+{
+  ASYNC::queue_conversion<std::string>(std::move(object), convert, std::move(done));
+}
+
+}; // lldc::reflection::converters::json
@@ -0,0 +1,48 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/json.h>
+#include <lldc-reflection/exceptions/exceptions.h>
+
+#include "private/batch/batch.h"
+
+namespace BATCH = lldc::reflection::batch;
+namespace EXCEPTIONS = lldc::reflection::exceptions;
+
+namespace lldc::reflection::converters::json {
+
+std::vector<std::string>
+to_json_batch (std::span<const ::rttr::instance> objects)
+{
+  return BATCH::run_conversions<std::string>(objects.size(), [&](size_t i) {
+    return to_json(objects[i]);
+  });
+}
+
+template <typename Text>
+static std::vector<bool>
+from_json_texts (std::span<const Text> texts, std::span<const ::rttr::instance> objects)
+{
+  if (texts.size() != objects.size())
+    throw EXCEPTIONS::BatchSizeMismatch();
+
+  return BATCH::run_conversions<bool>(texts.size(), [&](size_t i) {
+    return from_json(std::string_view(texts[i]), objects[i]);
+  });
+}
+
+std::vector<bool>
+from_json_batch (std::span<const std::string_view> texts, std::span<const ::rttr::instance> objects)
+{
+  return from_json_texts(texts, objects);
+}
+
+std::vector<bool>
+from_json_batch (std::span<const std::string> texts, std::span<const ::rttr::instance> objects)
+{
+  return from_json_texts(texts, objects);
+}
+
+}; // lldc::reflection::converters::json
@@ -0,0 +1,238 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Reads JSON text for the engine in a single pass: the reader is a cursor
+ * into the text itself, so nothing is built up in between (and values the
+ * engine does not ask for are only scanned over).
+ */
+
+#include <memory>
+#include <vector>
+
+#include <lldc-reflection/converters/json.h>
+
+#include "private/blob/blob.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/json/json.h"
+#include "private/stats/stats.h"
+#include "private/type/type.h"
+
+namespace BLOB = lldc::reflection::blob;
+namespace CONTEXT = lldc::reflection::context;
+namespace ENGINE = lldc::reflection::engine;
+namespace JSON = lldc::reflection::json;
+namespace STATS = lldc::reflection::stats;
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::converters::json {
+
+class JsonTextReader : public ENGINE::Reader {
+public:
+  JsonTextReader(std::string_view text, CONTEXT::State &state) :
+    ENGINE::Reader(state),
+    _p(text.data()),
+    _end(text.data() + text.size()),
+    _pending(true)
+  {
+    _p = JSON::skip_whitespace(_p, _end);
+  }
+
+  ENGINE::NodeKind kind() const override {
+    if (_p >= _end)
+      return ENGINE::NodeKind::null;
+
+    switch (*_p) {
+      case '{': return ENGINE::NodeKind::object;
+      case '[': return ENGINE::NodeKind::array;
+      case 'n': return ENGINE::NodeKind::null;
+      default:  return ENGINE::NodeKind::scalar;
+    }
+  }
+
+  size_t size_hint() const override {
+    return 0; // Not known without scanning ahead.
+  }
+
+  void begin_object() override {
+    enter('{');
+  }
+
+  bool next_member(std::string_view &key) override {
+    if (!next('}'))
+      return false;
+
+    if (!JSON::scan_key(_p, _end, state.key, key))
+      return malformed();
+    _p = JSON::skip_whitespace(_p, _end);
+    if (_p >= _end || *_p++ != ':')
+      return malformed();
+    _p = JSON::skip_whitespace(_p, _end);
+    return true;
+  }
+
+  void begin_array() override {
+    enter('[');
+  }
+
+  bool next_element() override {
+    return next(']');
+  }
+
+  bool read_scalar(TYPE::Scalar &value) override {
+    bool ok = false;
+    const char *p = _p;
+
+    if (p < _end) {
+      switch (*p) {
+        case '{':
+        case '[':
+        case 'n':
+          return false; // not a scalar; left to be skipped.
+        case '"':
+          ok = JSON::scan_string(p, _end, &value.string);
+          value.kind = TYPE::ScalarKind::string;
+          break;
+        case 't':
+        case 'f':
+          value.boolean = (*p == 't');
+          value.kind = TYPE::ScalarKind::boolean;
+          ok = JSON::skip_value(p, _end);
+          break;
+        default:
+          ok = JSON::scan_number(p, _end, &value);
+          break;
+      }
+    }
+
+    if (!ok)
+      return malformed();
+    _p = p;
+    _pending = false;
+    return true;
+  }
+
+  bool read_blob(std::string &out) override {
+    // Blobs are stored as the JSON itself, which is copied as it is.
+    const char *start = _p;
+    if (!skip())
+      return false;
+    out.assign(start, _p);
+    return true;
+  }
+
+  bool read_blob_value(Blob &out) override {
+    // The text is known to be well-formed, so it is not checked again.
+    const char *start = _p;
+    if (!skip())
+      return false;
+    out = Blob(std::make_shared<BLOB::TextValue>(std::string(start, _p), true));
+    return true;
+  }
+
+  /**
+   * @brief True if nothing but whitespace follows the root value.
+   */
+  bool at_end() {
+    if (_pending && !skip())
+      return false;
+    return JSON::skip_whitespace(_p, _end) == _end;
+  }
+
+private:
+  // Record the failure and stop: from here on, the input appears to end.
+  bool malformed() {
+    fail(ConversionError::malformed);
+    _p = _end;
+    _pending = false;
+    _first.clear();
+    return false;
+  }
+
+  // Skip the current value, which was not read.
+  bool skip() {
+    if (!JSON::skip_value(_p, _end, _first.size()))
+      return malformed();
+    _pending = false;
+    return true;
+  }
+
+  void enter(char open) {
+    if (_p >= _end || *_p != open || _first.size() >= JSON::MAX_DEPTH) {
+      malformed();
+      return;
+    }
+    _p++;
+    _first.push_back(true);
+    _pending = false;
+  }
+
+  // Move to the next value in the enclosing container, or past its end.
+  bool next(char close) {
+    if (failed() || (_pending && !skip()))
+      return false;
+
+    _p = JSON::skip_whitespace(_p, _end);
+    if (_p >= _end)
+      return malformed();
+
+    const bool first = _first.back();
+    if (*_p == close) {
+      _p++;
+      _first.pop_back();
+      return false;
+    }
+    if (!first && *_p++ != ',')
+      return malformed();
+
+    _first.back() = false;
+    _p = JSON::skip_whitespace(_p, _end);
+    _pending = true;
+    return true;
+  }
+
+  const char *_p;
+  const char *_end;
+  bool _pending;             // the current value has been neither read nor entered
+  std::vector<bool> _first;  // per open container: nothing in it visited yet
+};
+
+bool
+from_json (std::string_view text, ::rttr::instance obj, ConversionResult &result, ConversionContext &context)
+{
+  STATS::Sample sample(STATS::Converter::from_json, obj);
+  result = ConversionResult();
+
+  try {
+    CONTEXT::Lease lease(context);
+    JsonTextReader reader(text, lease.state());
+    if (reader.kind() != ENGINE::NodeKind::object)
+      reader.fail(ConversionError::not_an_object);
+    else if (ENGINE::read(reader, obj) && !reader.at_end())
+      reader.fail(ConversionError::malformed); // something after the object.
+    result = std::move(reader.result);
+  }
+  catch (...) {
+    result.error = ConversionError::exception;
+  }
+
+  if (result)
+    sample.succeeded(text.size());
+  return static_cast<bool>(result);
+}
+
+bool
+from_json (std::string_view text, ::rttr::instance obj, ConversionContext &context)
+{
+  ConversionResult result;
+  return from_json(text, obj, result, context);
+}
+
+bool
+from_json (std::span<const std::byte> bytes, ::rttr::instance obj, ConversionContext &context)
+{
+  return from_json(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()), obj, context);
+}
+
+}; // lldc::reflection::converters::json
@@ -0,0 +1,278 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Writes JSON text straight from the engine's writer calls.  A slot that
+ * is discarded is rolled back by truncating the text to where it began.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <lldc-reflection/converters/json.h>
+
+#include "private/blob/blob.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/json/json.h"
+#include "private/plan/plan.h"
+#include "private/stats/stats.h"
+#include "private/type/type.h"
+
+namespace BLOB = lldc::reflection::blob;
+namespace CONTEXT = lldc::reflection::context;
+namespace ENGINE = lldc::reflection::engine;
+namespace JSON = lldc::reflection::json;
+namespace PLAN = lldc::reflection::plan;
+namespace STATS = lldc::reflection::stats;
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::converters::json {
+
+// With a sink, completed top-level members are passed on once at least
+// this much text has accumulated.
+static const size_t SINK_CHUNK_SIZE = 16 * 1024;
+
+class JsonTextWriter : public ENGINE::Writer {
+public:
+  JsonTextWriter(std::string &out, const sink *flush_to, CONTEXT::State &state) :
+    ENGINE::Writer(state),
+    _out(out),
+    _sink(flush_to)
+  {
+    _stack.push_back(Entry{0, 0, 0, true}); // root slot
+  }
+
+  // A fork, writing into its own text.
+  explicit JsonTextWriter(CONTEXT::State &state) :
+    JsonTextWriter(_fork_text, nullptr, state)
+  {}
+
+  void begin_object() override {
+    _out += '{';
+    _stack.push_back(Entry{_out.size(), 0, 0, false});
+  }
+
+  void end_object() override {
+    _out += '}';
+    _stack.pop_back();
+  }
+
+  void begin_array() override {
+    _out += '[';
+    _stack.push_back(Entry{_out.size(), 0, 0, false});
+  }
+
+  void end_array() override {
+    _out += ']';
+    _closed_count = _stack.back().count;
+    _stack.pop_back();
+  }
+
+  void begin_member(const std::string &key) override {
+    open_slot();
+    JSON::append_string(_out, key);
+    _out += ':';
+    _stack.back().value_start = _out.size();
+  }
+
+  void begin_property(const PLAN::PropertyPlan &desc) override {
+    open_slot();
+    _out += desc.json_key;
+    _stack.back().value_start = _out.size();
+  }
+
+  void end_member(bool keep) override {
+    close_slot(keep);
+  }
+
+  void begin_element() override {
+    open_slot();
+    _stack.back().value_start = _out.size();
+  }
+
+  void end_element(bool keep) override {
+    close_slot(keep);
+  }
+
+  void reset_value() override {
+    while (!_stack.back().slot)
+      _stack.pop_back();
+    _out.resize(_stack.back().value_start);
+  }
+
+  void scalar(const TYPE::Scalar &value) override {
+    switch (value.kind) {
+      case TYPE::ScalarKind::boolean:
+        _out += (value.boolean) ? "true" : "false";
+        break;
+      case TYPE::ScalarKind::integer:
+        if (value.is_unsigned)
+          JSON::append_unsigned(_out, static_cast<uint64_t>(value.integer));
+        else
+          JSON::append_integer(_out, value.integer);
+        break;
+      case TYPE::ScalarKind::floating:
+        JSON::append_floating(_out, value.floating);
+        break;
+      default:
+        JSON::append_string(_out, value.string);
+        break;
+    }
+  }
+
+  void null() override {
+    _out += "null";
+  }
+
+  bool blob(const std::string &value) override {
+    // The blob is JSON already; it's copied in as long as it is valid.
+    if (!JSON::is_valid(value))
+      return false;
+
+    const char *end = value.data() + value.size();
+    const char *begin = JSON::skip_whitespace(value.data(), end);
+    while (end > begin && JSON::skip_whitespace(end - 1, end) == end)
+      end--;
+    _out.append(begin, end);
+    return true;
+  }
+
+  bool blob_value(const Blob &value) override {
+    // Text read from JSON is spliced in as it is; anything else is checked.
+    const auto text = dynamic_cast<const BLOB::TextValue*>(value.value().get());
+    if (text && text->checked) {
+      _out += text->text;
+      return true;
+    }
+    return ENGINE::Writer::blob_value(value);
+  }
+
+  bool can_fork() const override {
+    return true;
+  }
+
+  std::unique_ptr<ENGINE::Writer> fork(CONTEXT::State &state) const override {
+    return std::make_unique<JsonTextWriter>(state);
+  }
+
+  void join(ENGINE::Writer &fork) override {
+    // The fork's text is an array; its contents are this array's next elements.
+    const auto &other = static_cast<JsonTextWriter&>(fork);
+    if (other._closed_count == 0)
+      return;
+    if (_stack.back().count > 0)
+      _out += ',';
+    _out.append(other._out, 1, other._out.size() - 2);
+    _stack.back().count += other._closed_count;
+  }
+
+  /**
+   * @brief Pass whatever is left to the sink (if any).
+   */
+  void flush() {
+    if (_sink && !_out.empty()) {
+      (*_sink)(_out);
+      _flushed += _out.size();
+      _out.clear();
+    }
+  }
+
+  // The length of the text written so far, including what was flushed.
+  size_t length() const {
+    return _flushed + _out.size();
+  }
+
+private:
+  struct Entry {
+    size_t start;       // slots: where the slot (and its separator) began
+    size_t value_start; // slots: where the value began (after the key)
+    size_t count;       // containers: the number of members/elements kept
+    bool slot;
+  };
+
+  void open_slot() {
+    const bool separate = (_stack.back().count > 0);
+    _stack.push_back(Entry{_out.size(), 0, 0, true});
+    if (separate)
+      _out += ',';
+  }
+
+  void close_slot(bool keep) {
+    while (!_stack.back().slot)
+      _stack.pop_back();
+    const size_t start = _stack.back().start;
+    _stack.pop_back();
+
+    if (!keep) {
+      _out.resize(start);
+      return;
+    }
+
+    _stack.back().count++;
+
+    // The root object's members can no longer be discarded once kept.
+    if (_sink && _stack.size() == 2 && _out.size() >= SINK_CHUNK_SIZE) {
+      (*_sink)(_out);
+      _flushed += _out.size();
+      _out.clear();
+    }
+  }
+
+  std::string _fork_text;  // a fork's _out
+  std::string &_out;
+  const sink *_sink;
+  std::vector<Entry> _stack;
+  size_t _closed_count = 0;  // elements kept in the last array closed
+  size_t _flushed = 0;       // text already passed to the sink
+};
+
+bool
+to_json (::rttr::instance obj, std::string &out, ConversionContext &context)
+{
+  STATS::Sample sample(STATS::Converter::to_json, obj);
+  out.clear();
+  if (!obj.is_valid())
+    return false;
+
+  CONTEXT::Lease lease(context);
+  JsonTextWriter writer(out, nullptr, lease.state());
+  if (!ENGINE::write(obj, writer)) {
+    out.clear();
+    return false;
+  }
+  sample.succeeded(out.size());
+  return true;
+}
+
+std::string
+to_json (::rttr::instance obj, ConversionContext &context)
+{
+  std::string out;
+  to_json(obj, out, context);
+  return out;
+}
+
+bool
+to_json (::rttr::instance obj, const sink &out, ConversionContext &context)
+{
+  STATS::Sample sample(STATS::Converter::to_json, obj);
+  if (!obj.is_valid())
+    return false;
+
+  // The chunk buffer is the context's, so its capacity is kept between calls.
+  CONTEXT::Lease lease(context);
+  std::string &buffer = lease.state().buffer;
+  buffer.clear();
+  buffer.reserve(SINK_CHUNK_SIZE * 2);
+
+  JsonTextWriter writer(buffer, &out, lease.state());
+  if (!ENGINE::write(obj, writer))
+    return false;
+
+  writer.flush();
+  sample.succeeded(writer.length());
+  return true;
+}
+
+}; // lldc::reflection::converters::json
@@ -0,0 +1,32 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/socket-io.h>
+
+#include "private/async/async.h"
+
+namespace ASYNC = lldc::reflection::async;
+
+namespace lldc::reflection::converters {
+
+static ::sio::message::ptr
+convert (::rttr::instance object)
+{
+  return to_socket_io(object);
+}
+
+std::future<::sio::message::ptr>
+to_socket_io_async (::rttr::variant object)
+{
+  return ASYNC::queue_conversion<::sio::message::ptr>(std::move(object), convert);
+}
+
+void
+to_socket_io_async (::rttr::variant object, socket_io_completion done)
+{
+  ASYNC::queue_conversion<::sio::message::ptr>(std::move(object), convert, std::move(done));
+}
+
+}; // lldc::reflection::converters
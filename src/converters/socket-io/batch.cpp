@@ -0,0 +1,35 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <lldc-reflection/converters/socket-io.h>
+#include <lldc-reflection/exceptions/exceptions.h>
+
+#include "private/batch/batch.h"
+
+namespace BATCH = lldc::reflection::batch;
+namespace EXCEPTIONS = lldc::reflection::exceptions;
+
+namespace lldc::reflection::converters {
+
+std::vector<::sio::message::ptr>
+to_socket_io_batch (std::span<const ::rttr::instance> objects)
+{
+  return BATCH::run_conversions<::sio::message::ptr>(objects.size(), [&](size_t i) {
+    return to_socket_io(objects[i]);
+  });
+}
+
+std::vector<bool>
+from_socket_io_batch (std::span<const ::sio::message::ptr> messages, std::span<const ::rttr::instance> objects)
+{
+  if (messages.size() != objects.size())
+    throw EXCEPTIONS::BatchSizeMismatch();
+
+  return BATCH::run_conversions<bool>(messages.size(), [&](size_t i) {
+    return from_socket_io(messages[i], objects[i]);
+  });
+}
+
+}; // lldc::reflection::converters
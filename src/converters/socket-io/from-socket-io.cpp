@@ -4,22 +4,27 @@
  *
  * This is derived from the RTTR RapidJson example app and
  * the JsonGLIB variation (also inspired by that app) found
- * here in this library.
+ * here in this library.  The traversal itself now lives in the
+ * engine; this walks the sio::message tree for it.
  */
 
-#include <iostream>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <lldc-reflection/converters/socket-io.h>
-#include <lldc-reflection/metadata/metadata.h>
-#include <lldc-reflection/exceptions/exceptions.h>
 
-#include "private/associative-containers.h"
-#include "private/metadata/metadata.h"
+#include "private/blob/blob.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/stats/stats.h"
 #include "private/type/type.h"
 
-namespace AC = lldc::reflection::associative_containers;
-namespace METADATA = lldc::reflection::metadata;
-namespace EXCEPTIONS = lldc::reflection::exceptions;
+namespace BLOB = lldc::reflection::blob;
+namespace CONTEXT = lldc::reflection::context;
+namespace ENGINE = lldc::reflection::engine;
+namespace STATS = lldc::reflection::stats;
 namespace TYPE = lldc::reflection::type;
 
 namespace lldc::reflection::converters {
@@ -27,270 +32,214 @@ namespace lldc::reflection::converters {
 using sio_object = std::map<std::string, ::sio::message::ptr>;
 using sio_array = std::vector<::sio::message::ptr>;
 
-static void from_socket_io_recursively (const sio_object &message, ::rttr::instance obj2);
-static void write_array_recursively (const sio_array &array, ::rttr::variant_sequential_view &view);
-static void write_associative_view_recursively (const sio_array &array, ::rttr::variant_associative_view &view);
-static ::rttr::variant extract_basic_types (const ::sio::message &message, const ::rttr::type &t);
-static ::rttr::variant extract_value (const ::sio::message &message, const ::rttr::type &t);
-
-static inline bool is_a (const ::sio::message &ref, ::sio::message::flag flag) {
-  return (ref.get_flag() == flag);
-}
-
-static inline bool is_an_array (const ::sio::message &ref) {
-  return is_a(ref, ::sio::message::flag_array);
-}
-
-static inline bool is_a_basic_type (const ::sio::message &ref) {
-  return (
-    is_a(ref, ::sio::message::flag_double) ||
-    is_a(ref, ::sio::message::flag_null) ||
-    is_a(ref, ::sio::message::flag_integer) ||
-    is_a(ref, ::sio::message::flag_string)
-  );
-}
+/**
+ * @brief Walks an existing sio::message tree for the engine.  When consuming,
+ * strings and binary buffers are moved out of the nodes that only the tree
+ * holds (every pointer from the root down to them is unique), instead of
+ * copied; anything shared elsewhere is still copied.
+ */
+class SocketIOReader : public ENGINE::Reader {
+public:
+  SocketIOReader(const ::sio::message::ptr &root, bool consume, CONTEXT::State &state) :
+    ENGINE::Reader(state),
+    _current(root.get()),
+    _owned(consume && root.use_count() == 1)
+  {}
+
+  ENGINE::NodeKind kind() const override {
+    switch ((_current) ? _current->get_flag() : ::sio::message::flag_null) {
+      case ::sio::message::flag_object:   return ENGINE::NodeKind::object;
+      case ::sio::message::flag_array:    return ENGINE::NodeKind::array;
+      case ::sio::message::flag_binary:   return ENGINE::NodeKind::binary;
+      case ::sio::message::flag_null:     return ENGINE::NodeKind::null;
+      default:                            return ENGINE::NodeKind::scalar;
+    }
+  }
 
-static inline bool is_an_object (const ::sio::message &ref) {
-  return is_a(ref, ::sio::message::flag_object);
-}
+  size_t size_hint() const override {
+    return (kind() == ENGINE::NodeKind::array) ? _current->get_vector().size() : 0;
+  }
 
-static void
-write_array_recursively (const sio_array &array, ::rttr::variant_sequential_view &view)
-{
-  const ::rttr::type array_value_type = view.get_rank_type(1);
+  void begin_object() override {
+    const sio_object &map = _current->get_map();
+    _frames.push_back(Frame{_current, _owned, map.begin(), map.end(), 0});
+  }
 
-  view.set_size(array.size());
-  for (size_t i = 0; i < array.size(); i++) {
-    auto element = array.at(i);
+  bool next_member(std::string_view &key) override {
+    auto &frame = _frames.back();
 
-    if (is_an_array(*element)) {
-      auto sub_array_view = view.get_value(i).create_sequential_view();
-      write_array_recursively(element->get_vector(), sub_array_view);
-    }
-    else {
-      auto var = extract_value(*element, array_value_type);
-      if (var.is_valid())
-        view.set_value(i, var);
+    if (frame.member != frame.members_end) {
+      key = frame.member->first;
+      enter(frame, frame.member->second);
+      ++frame.member;
+      return true;
     }
-  }
-}
 
-static void
-write_associative_view_recursively (const sio_array &array, ::rttr::variant_associative_view &view)
-{
-  for (size_t i = 0; i < array.size(); i++) {
-    auto element = array.at(i);
+    leave();
+    return false;
+  }
 
-    if (is_an_object(*element)) {
-      // treat as: { 'key': <key>, 'value': <value> } view
-      auto element_key = element->get_map()[AC::KEY];
-      auto element_value = element->get_map()[AC::VALUE];
+  void begin_array() override {
+    _frames.push_back(Frame{_current, _owned, {}, {}, 0});
+  }
 
-      if (element_key.get() && element_value.get()) {
-        auto key_var = extract_value(*element_key, view.get_key_type());
-        auto value_var = extract_value(*element_value, view.get_value_type());
+  bool next_element() override {
+    auto &frame = _frames.back();
+    const sio_array &elements = frame.container->get_vector();
 
-        if (key_var && value_var)
-          view.insert(key_var, value_var);
-      }
-    }
-    else {
-      // a "key-only" associative view (??)
-      ::rttr::variant extracted_value = extract_basic_types(*element, view.get_key_type());
-      if (extracted_value && extracted_value.convert(view.get_key_type()))
-        view.insert(extracted_value);
+    if (frame.index < elements.size()) {
+      enter(frame, elements[frame.index++]);
+      return true;
     }
+
+    leave();
+    return false;
   }
-}
 
-static ::rttr::variant
-extract_basic_types (const ::sio::message &message, const ::rttr::type &t)
-{
-  switch (message.get_flag()) {
-    // Big fall-through to default for data marshalling
-    // basic types.
-    case ::sio::message::flag_boolean: {
-      auto ref = message.get_bool();
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
-    }
-    case ::sio::message::flag_double: {
-      auto ref = message.get_double();
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
-    }
-    case ::sio::message::flag_integer: {
-      auto temp = message.get_int();
-      if (t == ::rttr::type::get<uint8_t>()) {
-        return static_cast<uint8_t> (temp);
-      }
-      else if (t == ::rttr::type::get<uint16_t>()) {
-        return static_cast<uint16_t> (temp);
-      }
-      else if (t == ::rttr::type::get<uint32_t>()) {
-        return static_cast<uint32_t> (temp);
-      }
-      else if (t == ::rttr::type::get<uint64_t>()) {
-        return static_cast<uint64_t> (temp);
-      }
-      else if (TYPE::is_any(t)) {
-        return std::any(temp);
-      }
-      return temp;
-    }
-    case ::sio::message::flag_string: {
-      auto ref = message.get_string();
-      if (TYPE::is_any(t))
-        return std::any(ref);
-      return ref;
+  bool read_scalar (TYPE::Scalar &value) override {
+    if (!_current)
+      return false;
+
+    switch (_current->get_flag()) {
+      case ::sio::message::flag_boolean:
+        value.kind = TYPE::ScalarKind::boolean;
+        value.boolean = _current->get_bool();
+        break;
+      case ::sio::message::flag_double:
+        value.kind = TYPE::ScalarKind::floating;
+        value.floating = _current->get_double();
+        break;
+      case ::sio::message::flag_integer:
+        value.kind = TYPE::ScalarKind::integer;
+        value.integer = _current->get_int();
+        value.is_unsigned = false;
+        break;
+      case ::sio::message::flag_string:
+        value.kind = TYPE::ScalarKind::string;
+        if (_owned)
+          value.string = std::move(const_cast<std::string&>(_current->get_string()));
+        else
+          value.string = _current->get_string();
+        break;
+      default:
+        return false;
     }
-    default:
-      break;
+    return true;
   }
-  return ::rttr::variant();
-}
 
-static ::rttr::variant
-extract_value (const ::sio::message &message, const ::rttr::type &t)
-{
-  ::rttr::variant extracted_value = extract_basic_types(message, t);
-  const bool could_convert = extracted_value.can_convert(t);
+  bool read_blob (std::string &out) override {
+    // Blob members are written out as binary messages.
+    if (kind() != ENGINE::NodeKind::binary)
+      return false;
 
-  if (could_convert) {
-    extracted_value.convert(t);
+    const auto &blob = _current->get_binary();
+    if (!blob)
+      return false;
+    out = *blob;
+    return true;
   }
-  else {
-    if (is_an_object(message)) {
-      auto local_value_t = t;
 
-      if (local_value_t.is_wrapper())
-        local_value_t = local_value_t.get_wrapped_type();
+  bool read_blob_buffer (std::shared_ptr<const std::string> &out) override {
+    // Hand over the message's own buffer rather than a copy.
+    if (kind() != ENGINE::NodeKind::binary || !_current->get_binary())
+      return false;
+    if (_owned)
+      out = std::move(const_cast<std::shared_ptr<const std::string>&>(_current->get_binary()));
+    else
+      out = _current->get_binary();
+    return true;
+  }
 
-      ::rttr::constructor ctor = local_value_t.get_constructor();
-      for (auto &item : local_value_t.get_raw_type().get_constructors()) {
-        if (item.get_instantiated_type() == t) {
-          ctor = item;
-          break;
-        }
-      }
+  bool read_blob_value (Blob &out) override {
+    std::shared_ptr<const std::string> buffer;
+    if (!read_blob_buffer(buffer))
+      return false;
+    out = Blob(std::make_shared<BLOB::BufferValue>(std::move(buffer)));
+    return true;
+  }
 
-      if (ctor.is_valid())
-        extracted_value = ctor.invoke();
+private:
+  struct Frame {
+    const ::sio::message *container;
+    bool owned;
+    sio_object::const_iterator member;
+    sio_object::const_iterator members_end;
+    size_t index;
+  };
+
+  void enter(const Frame &frame, const ::sio::message::ptr &child) {
+    _current = child.get();
+    _owned = frame.owned && child.use_count() == 1;
+  }
 
-      from_socket_io_recursively (message.get_map(), extracted_value);
-    }
+  void leave() {
+    _current = _frames.back().container;
+    _owned = _frames.back().owned;
+    _frames.pop_back();
   }
 
-  return extracted_value;
-}
+  // sio::message only has const get_string() and get_binary(); _owned says
+  // the node is only reachable from the tree being consumed, so its
+  // (non-const) string or buffer can be moved out all the same.
+  const ::sio::message *_current;
+  bool _owned;
+  std::vector<Frame> _frames;
+};
 
-static void
-from_socket_io_recursively (const sio_object &message, ::rttr::instance obj2)
+static bool
+read_message (const ::sio::message::ptr &message, bool consume, ::rttr::instance object, ConversionResult &result, ConversionContext &context)
 {
-  ::rttr::instance obj = obj2.get_type().get_raw_type().is_wrapper() ? obj2.get_wrapped_instance() : obj2;
-  const auto prop_list = obj.get_derived_type().get_properties();
-
-  for (auto prop : prop_list)
-  {
-    auto name = prop.get_name().to_string();
-    auto optional = METADATA::is_optional(prop, nullptr);
-    if (message.end() == message.find(name)) {
-      if (optional)
-        continue; // Okay to skip restoration
-      throw EXCEPTIONS::RequiredMemberSerializationFailure(name);
+  STATS::Sample sample(STATS::Converter::from_socket_io, object);
+  result = ConversionResult();
+
+  if (message && message->get_flag() == ::sio::message::flag_object) {
+    try {
+      CONTEXT::Lease lease(context);
+      SocketIOReader reader(message, consume, lease.state());
+      ENGINE::read(reader, object);
+      result = std::move(reader.result);
+      if (result)
+        sample.succeeded(reader.bytes);
     }
-    auto member = message.at(name);
-    auto member_flag = (member) ? member->get_flag() : ::sio::message::flag_null;
-
-    auto const value_t = prop.get_type();
-    ::rttr::variant var;
-
-    switch (member_flag) {
-      case ::sio::message::flag_array: {
-        ::rttr::type local_value_t = value_t;
-        if (value_t.is_wrapper())
-          local_value_t = value_t.get_wrapped_type();
-
-        if (local_value_t.is_sequential_container()) {
-          var = prop.get_value(obj);
-          auto view = var.create_sequential_view();
-          write_array_recursively(member->get_vector(), view);
-        }
-        else if (local_value_t.is_associative_container()) {
-          var = prop.get_value(obj);
-          auto view = var.create_associative_view();
-          write_associative_view_recursively(member->get_vector(), view);
-        }
-        else if (METADATA::is_blob(prop)) {
-          auto blob = member->get_binary();
-          if (blob.get())
-            var = std::string(blob.get()->c_str());
-        }
-        prop.set_value(obj, var);
-        break;
-      }
-      case ::sio::message::flag_object: {
-        if (METADATA::is_blob(prop)) {
-          auto blob = member->get_binary();
-          if (blob.get())
-            var = std::string(blob.get()->c_str());
-        }
-        else {
-          ::rttr::type local_value_t = value_t;
-          if (value_t.is_wrapper())
-            local_value_t = value_t.get_wrapped_type();
-
-          var = prop.get_value(obj);
-          if (local_value_t.is_pointer()) {
-            auto ctor = local_value_t.get_constructor();
-            for (auto& item : local_value_t.get_raw_type().get_constructors()) {
-              if (item.get_instantiated_type() == value_t) {
-                ctor = item;
-                break;
-              }
-            }
-            if (ctor.is_valid())
-              var = ctor.invoke();
-          }
-
-          from_socket_io_recursively(member->get_map(), var);
-        }
-        prop.set_value(obj, var);
-        break;
-      }
-      case ::sio::message::flag_null: {
-        prop.set_value(obj, nullptr);
-        break;
-      }
-      default:
-        // REMARK: this conversion only works with "const type".
-        var = extract_basic_types(*member, value_t);
-        if (var.convert(value_t))
-          prop.set_value(obj, var);
+    catch (...) {
+      result.error = ConversionError::exception;
     }
   }
+  else {
+    result.error = ConversionError::not_an_object;
+  }
+
+  return static_cast<bool>(result);
 }
 
+bool
+from_socket_io (const ::sio::message::ptr &message, ::rttr::instance object, ConversionResult &result, ConversionContext &context)
+{
+  return read_message(message, false, object, result, context);
+}
 
 bool
-from_socket_io (const ::sio::message::ptr message, ::rttr::instance object)
+from_socket_io (const ::sio::message::ptr &message, ::rttr::instance object, ConversionContext &context)
 {
-  bool success = false;
+  ConversionResult result;
+  return read_message(message, false, object, result, context);
+}
 
-  if (message && message->get_flag() == ::sio::message::flag_object) {
-    try {
-      from_socket_io_recursively (message->get_map(), object);
-      success = true;
-    }
-    catch (...) {
-      // do nothing here; returning false.
-      success = false;
-    }
-  }
+bool
+from_socket_io (::sio::message::ptr &&message, ::rttr::instance object, ConversionResult &result, ConversionContext &context)
+{
+  // Take the message over, so the caller's pointer is left empty and the tree
+  // is released here, once its contents have been moved out.
+  auto owned = std::move(message);
+  return read_message(owned, true, object, result, context);
+}
 
-  return success;
+bool
+from_socket_io (::sio::message::ptr &&message, ::rttr::instance object, ConversionContext &context)
+{
+  ConversionResult result;
+  auto owned = std::move(message);
+  return read_message(owned, true, object, result, context);
 }
 
 }; // lldc::reflection::converters
@@ -4,302 +4,242 @@
  *
  * This is derived from the RTTR Json example app which utilized
  * rapidjson for its backend and the lldc_appsync variation which
- * utilized JsonGLIB for its incarnation.
+ * utilized JsonGLIB for its incarnation.  The traversal itself now
+ * lives in the engine; this builds the sio::message tree from its
+ * writer calls.
  */
 
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include <lldc-reflection/converters/socket-io.h>
-#include <lldc-reflection/metadata/metadata.h>
-#include <lldc-reflection/exceptions/exceptions.h>
 
-#include "private/associative-containers.h"
-#include "private/metadata/metadata.h"
+#include "private/blob/blob.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/plan/plan.h"
+#include "private/stats/stats.h"
 #include "private/type/type.h"
 
-namespace AC = lldc::reflection::associative_containers;
-namespace METADATA = lldc::reflection::metadata;
+namespace BLOB = lldc::reflection::blob;
+namespace CONTEXT = lldc::reflection::context;
+namespace ENGINE = lldc::reflection::engine;
+namespace PLAN = lldc::reflection::plan;
+namespace STATS = lldc::reflection::stats;
 namespace TYPE = lldc::reflection::type;
 
-using sio_object = std::map<std::string, ::sio::message::ptr>;
-using sio_array = std::vector<::sio::message::ptr>;
-
-
 namespace lldc::reflection::converters {
 
-static bool to_socket_io_recursive(const ::rttr::instance &rttr_obj, sio_object &object);
-static bool write_variant(const ::rttr::variant &var, ::sio::message::ptr &member, bool optional=false);
-static bool attempt_write_fundamental_type (const ::rttr::type &t, const ::rttr::variant &var, ::sio::message::ptr &member, bool optional=false);
-static bool write_array (const ::rttr::variant_sequential_view &view, ::sio::message::ptr &member, bool optional=false);
-static bool write_associative_container (const ::rttr::variant_associative_view &view, ::sio::message::ptr &member, bool optional=false);
-
-static bool
-attempt_write_fundamental_type(
-  const ::rttr::type &t,
-  const ::rttr::variant &var,
-  ::sio::message::ptr &member,
-  bool optional)
-{
-  bool did_write = false;
+/**
+ * @brief Builds the sio::message tree.  Each slot holds the message written
+ * into it until the slot is closed, when it is added to the enclosing object
+ * or array (or dropped, if it is not kept).
+ *
+ * A registered property's message waits in _pending, in the place given by
+ * its PropertyPlan::key_rank, until its object ends; the object's members
+ * then go into its std::map in that order, each at the end without a search.
+ */
+class SocketIOWriter : public ENGINE::Writer {
+public:
+  explicit SocketIOWriter(CONTEXT::State &state) : ENGINE::Writer(state) {
+    _stack.push_back(Entry{}); // root slot
+  }
 
-  if (t.is_arithmetic()) {
-    // Is a Number
-    if (t == ::rttr::type::get<bool>()) {
-      member = ::sio::bool_message::create(var.to_bool());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<char>()) {
-      member = ::sio::string_message::create(var.to_string());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int>()) {
-      member = ::sio::int_message::create(var.to_int());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int8_t>()) {
-      member = ::sio::int_message::create(var.to_int8());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int16_t>()) {
-      member = ::sio::int_message::create(var.to_int16());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int32_t>()) {
-      member = ::sio::int_message::create(var.to_int32());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<int64_t>()) {
-      member = ::sio::int_message::create(var.to_int64());
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint8_t>()) {
-      member = ::sio::int_message::create(static_cast<int64_t>(var.to_uint8()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint16_t>()) {
-      member = ::sio::int_message::create(static_cast<int64_t>(var.to_uint16()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint32_t>()) {
-      member = ::sio::int_message::create(static_cast<int64_t>(var.to_uint32()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<uint64_t>()) {
-      member = ::sio::int_message::create(static_cast<int64_t>(var.to_uint64()));
-      did_write = true;
-    }
-    else if (t == ::rttr::type::get<float>() || t == ::rttr::type::get<double>()) {
-      member = ::sio::double_message::create(var.to_double());
-      did_write = true;
-    }
+  ::sio::message::ptr take_root() {
+    ::sio::message::ptr root;
+    root.swap(_stack.front().message);
+    return root;
   }
-  else if (t.is_enumeration()) {
-    // Enumeration as a string
-    // Attempt to serialize it as a string
-    bool ok = false;
-    auto result = var.to_string(&ok);
-
-    if (ok && !(optional && result.empty())) {
-      member = ::sio::string_message::create(var.to_string());
-      did_write = true;
-    }
-    else {
-      // Attempt treating as a number
-      auto value = var.to_int64(&ok);
-      if (ok)
-        member = ::sio::int_message::create(value);
-      else
-        member = ::sio::null_message::create();
-    }
-    did_write = true;
+
+  void begin_object() override {
+    set_value(::sio::object_message::create());
+    _stack.push_back(Entry{_stack.back().message, nullptr, false, NO_RANK, _pending.size()});
   }
-  else if (t == ::rttr::type::get<std::string>()) {
-    auto result = var.to_string();
-
-    if (!(optional && result.empty())) {
-      if (METADATA::is_blob(t)) {
-        member = ::sio::binary_message::create(std::make_shared<std::string>(result));
-      }
-      else {
-        member = ::sio::string_message::create(result);
-      }
-      did_write = true;
-    }
+
+  void end_object() override {
+    add_pending_members();
+    _stack.pop_back();
   }
 
-  return did_write;
-}
+  void begin_array() override {
+    set_value(::sio::array_message::create());
+    _stack.push_back(Entry{_stack.back().message, nullptr, false, NO_RANK, _pending.size()});
+  }
 
-static bool
-write_array (
-  const ::rttr::variant_sequential_view &view,
-  ::sio::message::ptr &member,
-  bool optional)
-{
-  if (optional && view.get_size() == 0)
-    return false; // Don't bother serializing
+  void end_array() override {
+    _stack.pop_back();
+  }
 
-  member = sio::array_message::create();
+  void begin_member(const std::string &key) override {
+    _stack.push_back(Entry{nullptr, &key, true});
+  }
 
-  for (const auto& item : view) {
-    auto entry = ::sio::message::ptr();
-    if (write_variant(item, entry, optional)) {
-      member->get_vector().push_back(entry);
-    }
+  void begin_property(const PLAN::PropertyPlan &desc) override {
+    _stack.push_back(Entry{nullptr, &desc.key, true, desc.key_rank});
   }
-  return true;
-}
 
-static bool
-write_associative_container (
-  const ::rttr::variant_associative_view &view,
-  ::sio::message::ptr &member,
-  bool optional)
-{
-  if (optional && view.get_size() == 0)
-    return false;
-
-  auto array = sio::array_message::create();
-
-  // From the original source code comments:
-  //   "Dealing with keys = values containers like sets"
-  // However the RTTR docs say this method returns TRUE if the
-  // associative container is like a set, where it only contains
-  // keys.
-  if (view.is_key_only_type()) {
-    for (auto& item : view) {
-      ::sio::message::ptr element;
-      if (write_variant(item.first, element)) {
-        array->get_vector().push_back(element);
-      }
+  void end_member(bool keep) override {
+    auto slot = close_slot();
+    if (!keep || !slot.message)
+      return;
+    if (slot.rank == NO_RANK) {
+      _stack.back().message->get_map()[*slot.key] = std::move(slot.message);
     }
-  }
-  else {
-    // Original is pretty clearly doing this:
-    //   vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
-    // [ {'key': <key>, 'value': <value>}, ... ]
-    for (auto& item : view) {
-      ::sio::message::ptr key;
-      ::sio::message::ptr value;
-
-      if (write_variant(item.first, key) && write_variant(item.second, value)) {
-        auto obj = sio::object_message::create();
-        obj->get_map()[AC::KEY] = key;
-        obj->get_map()[AC::VALUE] = value;
-
-        array->get_vector().push_back(obj);
-      }
+    else {
+      const size_t at = _stack.back().pending + slot.rank;
+      if (_pending.size() <= at)
+        _pending.resize(at + 1);
+      _pending[at] = Member{slot.key, std::move(slot.message)};
     }
   }
 
-  // Even if it's empty, it's okay because we've established
-  // it's !optional.
-  member = array;
-  return true;
-}
+  void begin_element() override {
+    _stack.push_back(Entry{nullptr, nullptr, true});
+  }
 
-static bool
-write_variant(const ::rttr::variant &var, ::sio::message::ptr &member, bool optional)
-{
-  bool did_write = false;
-
-  // Deal with wrapped types.
-  ::rttr::variant localVar = var;
-  ::rttr::type varType = var.get_type();
-  if (varType.is_wrapper()) {
-    varType = varType.get_wrapped_type();
-    localVar = localVar.extract_wrapped_value();
+  void end_element(bool keep) override {
+    auto slot = close_slot();
+    if (keep && slot.message)
+      _stack.back().message->get_vector().push_back(std::move(slot.message));
   }
 
-  // If the varType is holding a std::any, it needs to be unpacked.
-  if (TYPE::is_any(varType)) {
-    did_write = write_variant(TYPE::extract_any_value(localVar), member, optional);
+  void reset_value() override {
+    while (!_stack.back().slot)
+      pop_container();
+    set_value(nullptr);
   }
-  else if (TYPE::is_fundamental(varType)) {
-    did_write = attempt_write_fundamental_type(varType, localVar, member, optional);
+
+  void scalar(const TYPE::Scalar &value) override {
+    switch (value.kind) {
+      case TYPE::ScalarKind::boolean:
+        set_value(::sio::bool_message::create(value.boolean));
+        break;
+      case TYPE::ScalarKind::integer:
+        set_value(::sio::int_message::create(value.integer));
+        break;
+      case TYPE::ScalarKind::floating:
+        set_value(::sio::double_message::create(value.floating));
+        break;
+      default:
+        set_value(::sio::string_message::create(value.string));
+        break;
+    }
   }
-  else if (localVar.is_sequential_container()) {
-    did_write = write_array(localVar.create_sequential_view(), member, optional);
+
+  void null() override {
+    set_value(::sio::null_message::create());
   }
-  else if (localVar.is_associative_container()) {
-    did_write = write_associative_container(localVar.create_associative_view(), member, optional);
+
+  bool blob(const std::string &value) override {
+    set_value(::sio::binary_message::create(std::make_shared<std::string>(value)));
+    return true;
   }
-  else {
-    // Not fundamental or container -- treat as object.
-    auto temp = ::sio::object_message::create();
-    if (to_socket_io_recursive(localVar, temp->get_map())) {
-      member.swap(temp);
-      did_write = true;
-    }
-    else if (!optional) {
-      // Source member is "empty" and required.
-      // If it's a pointer-type, represent it as a nullptr
-      // If not, represent it as an empty object.
-      if (varType.is_pointer())
-        temp = ::sio::null_message::create();
-      member.swap(temp);
-      did_write = true;
-    }
+
+  bool blob_buffer(const std::shared_ptr<const std::string> &value) override {
+    // The message shares the buffer; nothing is copied.
+    set_value(::sio::binary_message::create(value));
+    return true;
   }
 
-  return did_write;
-}
+  bool blob_value(const Blob &value) override {
+    if (const auto shared = dynamic_cast<const BLOB::BufferValue*>(value.value().get()))
+      return blob_buffer(shared->buffer);
+    return ENGINE::Writer::blob_value(value);
+  }
 
-static bool
-to_socket_io_recursive(const ::rttr::instance &obj2, sio_object &object)
-{
-  bool did_write = false;
-  ::rttr::instance obj = obj2.get_type().get_raw_type().is_wrapper() ? obj2.get_wrapped_instance() : obj2;
-
-  auto prop_list = obj.get_derived_type().get_properties();
-  for (auto prop : prop_list)
-  {
-    const auto name = prop.get_name();
-    ::rttr::variant prop_value = prop.get_value(obj);
-    bool matches_default = false;
-    bool optional = METADATA::is_optional(prop, prop_value, &matches_default);
-
-    if (METADATA::is_no_serialize(prop)) {
-      did_write = true;
-      continue; // skip it
-    }
+  bool can_fork() const override {
+    return true;
+  }
 
-    if (optional && matches_default) {
-      did_write = true;
-      continue; // By implication, skip it.
-    }
+  std::unique_ptr<ENGINE::Writer> fork(CONTEXT::State &state) const override {
+    return std::make_unique<SocketIOWriter>(state);
+  }
 
-    if (optional && !prop_value) {
-      did_write = true;
-      continue; // null-like and it's optional; skip it.
-    }
+  void join(ENGINE::Writer &fork) override {
+    // The fork's root is an array; its elements are this array's next ones.
+    const auto &root = static_cast<SocketIOWriter&>(fork)._stack.front().message;
+    if (!root)
+      return;
 
-    ::sio::message::ptr member;
-    if (write_variant(prop_value, member, optional)) {
-      did_write = true;
-      object[name.to_string()] = member;
-    }
-    else if (!optional) {
-      // Failed write and not optional -> error condition
-      throw exceptions::RequiredMemberSerializationFailure(name.to_string());
-    }
+    auto &from = root->get_vector();
+    auto &to = _stack.back().message->get_vector();
+    to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
   }
 
-  return did_write;
-}
+private:
+  static constexpr uint32_t NO_RANK = std::numeric_limits<uint32_t>::max();
+
+  struct Entry {
+    ::sio::message::ptr message;
+    const std::string *key = nullptr;
+    bool slot = true;
+    uint32_t rank = NO_RANK;  // members: the property's key_rank, if any
+    size_t pending = 0;       // objects and arrays: where their _pending start
+  };
+
+  // An object's pending member, by key_rank; none (no message) if not written.
+  struct Member {
+    const std::string *key = nullptr;
+    ::sio::message::ptr message;
+  };
+
+  void set_value(::sio::message::ptr message) {
+    _stack.back().message = std::move(message);
+  }
+
+  // Pop an object or array, discarding any members it left pending.
+  void pop_container() {
+    _pending.erase(_pending.begin() + _stack.back().pending, _pending.end());
+    _stack.pop_back();
+  }
+
+  // Pop the innermost slot (and anything left open inside it).
+  Entry close_slot() {
+    while (!_stack.back().slot)
+      pop_container();
+    auto slot = std::move(_stack.back());
+    _stack.pop_back();
+    return slot;
+  }
+
+  void add_pending_members() {
+    const auto first = _pending.begin() + _stack.back().pending;
+    auto &map = _stack.back().message->get_map();
+    for (auto it = first; it != _pending.end(); ++it) {
+      if (!it->message)
+        continue;
+      const auto size = map.size();
+      auto at = map.try_emplace(map.end(), *it->key, std::move(it->message));
+      if (map.size() == size)
+        at->second = std::move(it->message); // a key registered twice; the last one wins
+    }
+    _pending.erase(first, _pending.end());
+  }
+
+  std::vector<Entry> _stack;
+  std::vector<Member> _pending;
+};
 
 ::sio::message::ptr
-to_socket_io (::rttr::instance object)
+to_socket_io (::rttr::instance object, ConversionContext &context)
 {
   ::sio::message::ptr out;
   out.reset();
+  STATS::Sample sample(STATS::Converter::to_socket_io, object);
 
   if (object.is_valid()) {
-    auto temp = ::sio::object_message::create();
-    if (to_socket_io_recursive(object, temp->get_map())) {
-      out = temp;
+    CONTEXT::Lease lease(context);
+    SocketIOWriter writer(lease.state());
+    if (ENGINE::write(object, writer)) {
+      out = writer.take_root();
+      sample.succeeded(writer.bytes);
     }
   }
 
   return out;
 }
 
-}; // lldc::reflection::converters
\ No newline at end of file
+}; // lldc::reflection::converters
@@ -0,0 +1,384 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * The converter-neutral "from" traversal, which grew out of the RTTR
+ * RapidJSON from_json example by way of the JsonGLIB and SocketIO
+ * converters.
+ */
+
+#include <string>
+
+#include "private/associative-containers.h"
+#include "private/engine/engine.h"
+#include "private/plan/plan.h"
+#include "private/probes/probes.h"
+#include "private/trace/trace.h"
+#include "private/type/type.h"
+
+namespace AC = lldc::reflection::associative_containers;
+namespace PLAN = lldc::reflection::plan;
+namespace PROBES = lldc::reflection::probes;
+namespace TRACE = lldc::reflection::trace;
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::engine {
+
+static bool read_object (Reader &reader, ::rttr::instance obj2);
+static bool read_member (Reader &reader, const PLAN::PropertyPlan &desc, ::rttr::instance &obj);
+static bool read_array (Reader &reader, ::rttr::variant_sequential_view &view);
+static bool read_associative_view (Reader &reader, ::rttr::variant_associative_view &view);
+static bool read_value (Reader &reader, const ::rttr::type &t, ::rttr::variant &out);
+static ::rttr::variant construct (const ::rttr::type &t);
+
+// The path of a failure is built as it unwinds, so nothing is spent on it
+// unless something failed.  Each returns false, for the caller to return.
+static bool
+failed_in_member (Reader &reader, const std::string &name)
+{
+  reader.result.path.insert(0, "/" + name);
+  return false;
+}
+
+static bool
+failed_in_element (Reader &reader, size_t index)
+{
+  reader.result.path.insert(0, "[" + std::to_string(index) + "]");
+  return false;
+}
+
+// Read the current scalar or blob, counting its bytes.
+static bool
+take_scalar (Reader &reader, TYPE::Scalar &scalar)
+{
+  if (!reader.read_scalar(scalar))
+    return false;
+  if (scalar.kind == TYPE::ScalarKind::string || scalar.kind == TYPE::ScalarKind::character)
+    reader.bytes += scalar.string.size();
+  return true;
+}
+
+static bool
+take_blob (Reader &reader, std::string &blob)
+{
+  if (!reader.read_blob(blob))
+    return false;
+  reader.bytes += blob.size();
+  return true;
+}
+
+static bool
+take_blob_buffer (Reader &reader, std::shared_ptr<const std::string> &buffer)
+{
+  if (!reader.read_blob_buffer(buffer))
+    return false;
+  if (buffer)
+    reader.bytes += buffer->size();
+  return true;
+}
+
+// Read the current value into a Blob; null is an empty one.
+static bool
+read_blob_variant (Reader &reader, ::rttr::variant &out)
+{
+  Blob blob;
+  if (reader.kind() != NodeKind::null && !reader.read_blob_value(blob))
+    return !reader.failed();
+  out = std::move(blob);
+  return true;
+}
+
+static ::rttr::variant
+construct (const ::rttr::type &t)
+{
+  auto local_value_t = t;
+
+  if (local_value_t.is_wrapper())
+    local_value_t = local_value_t.get_wrapped_type();
+
+  ::rttr::constructor ctor = local_value_t.get_constructor();
+  for (auto& item : local_value_t.get_raw_type().get_constructors()) {
+    if (item.get_instantiated_type() == t) {
+      ctor = item;
+      break;
+    }
+  }
+
+  if (ctor.is_valid())
+    return ctor.invoke();
+  return ::rttr::variant();
+}
+
+static bool
+read_array (Reader &reader, ::rttr::variant_sequential_view &view)
+{
+  const ::rttr::type array_value_type = view.get_rank_type(1);
+  const bool blobs = (array_value_type == ::rttr::type::get<Blob>());
+  const bool value_objects = !blobs && TYPE::is_value_object(array_value_type);
+
+  // Start from default-constructed elements, as if each were created anew,
+  // sized up front when the reader knows the length.
+  view.clear();
+  if (const size_t hint = reader.size_hint())
+    view.set_size(hint);
+
+  size_t i = 0;
+  reader.begin_array();
+  for (; reader.next_element(); i++) {
+    if (i >= view.get_size() && !view.set_size(i + 1))
+      continue; // fixed-size container; nowhere to put it.
+
+    // Elements are std::reference_wrappers into the container, so nested
+    // arrays and by-value objects are decoded where set_size() left them.
+    bool ok = true;
+    const auto kind = reader.kind();
+    if (kind == NodeKind::array && !blobs) {
+      auto sub_array_view = view.get_value(i).create_sequential_view();
+      ok = read_array(reader, sub_array_view);
+    }
+    else if (kind == NodeKind::object && value_objects) {
+      ok = read_object(reader, view.get_value(i));
+    }
+    else {
+      ::rttr::variant var;
+      ok = read_value(reader, array_value_type, var);
+      if (ok && var.is_valid())
+        view.set_value(i, var);
+    }
+
+    if (!ok)
+      return failed_in_element(reader, i);
+  }
+
+  if (reader.failed())
+    return false;
+  if (i < view.get_size())
+    view.set_size(i);
+  return true;
+}
+
+static bool
+read_associative_view (Reader &reader, ::rttr::variant_associative_view &view)
+{
+  size_t i = 0;
+  reader.begin_array();
+  for (; reader.next_element(); i++) {
+    if (reader.kind() == NodeKind::object) {
+      // Treat as: { 'key': <key>, 'value': <value>} view.
+      ::rttr::variant key_var;
+      ::rttr::variant value_var;
+      std::string_view name;
+
+      reader.begin_object();
+      while (reader.next_member(name)) {
+        if (name == AC::KEY) {
+          if (!read_value(reader, view.get_key_type(), key_var)) {
+            failed_in_member(reader, AC::KEY);
+            return failed_in_element(reader, i);
+          }
+        }
+        else if (name == AC::VALUE) {
+          if (!read_value(reader, view.get_value_type(), value_var)) {
+            failed_in_member(reader, AC::VALUE);
+            return failed_in_element(reader, i);
+          }
+        }
+      }
+      if (reader.failed())
+        return failed_in_element(reader, i);
+
+      if (key_var && value_var)
+        view.insert(key_var, value_var);
+    }
+    else {
+      // a "key-only" associative view (??)
+      TYPE::Scalar &scalar = reader.state.scalar;
+      if (take_scalar(reader, scalar)) {
+        ::rttr::variant extracted_value = TYPE::decode_scalar_to(scalar, view.get_key_type());
+        if (extracted_value && extracted_value.convert(view.get_key_type()))
+          view.insert(extracted_value);
+      }
+      else if (reader.failed()) {
+        return failed_in_element(reader, i);
+      }
+    }
+  }
+
+  return !reader.failed();
+}
+
+static bool
+read_value (Reader &reader, const ::rttr::type &t, ::rttr::variant &out)
+{
+  if (t == ::rttr::type::get<Blob>())
+    return read_blob_variant(reader, out);
+
+  switch (reader.kind()) {
+    case NodeKind::scalar: {
+      TYPE::Scalar &scalar = reader.state.scalar;
+      if (take_scalar(reader, scalar)) {
+        out = TYPE::decode_scalar_to(scalar, t);
+        if (out.can_convert(t))
+          out.convert(t);
+      }
+      return !reader.failed();
+    }
+    case NodeKind::object:
+      out = construct(t);
+      return read_object(reader, out);
+    default:
+      return true;
+  }
+}
+
+static bool
+read_member (Reader &reader, const PLAN::PropertyPlan &desc, ::rttr::instance &obj)
+{
+  const auto &prop = desc.property;
+  auto const value_t = prop.get_type();
+  ::rttr::variant var;
+
+  if (desc.kind == PLAN::ValueKind::buffer) {
+    std::shared_ptr<const std::string> buffer;
+    if (reader.kind() != NodeKind::null && !take_blob_buffer(reader, buffer))
+      return !reader.failed();
+    prop.set_value(obj, buffer);
+    return !reader.failed();
+  }
+
+  if (desc.kind == PLAN::ValueKind::blob) {
+    if (!read_blob_variant(reader, var))
+      return false;
+    if (var.is_valid())
+      prop.set_value(obj, var);
+    return !reader.failed();
+  }
+
+  switch (reader.kind()) {
+    case NodeKind::array: {
+      bool ok = true;
+      if (desc.kind == PLAN::ValueKind::sequential) {
+        var = desc.get_target(obj);
+        auto view = var.create_sequential_view();
+        ok = read_array(reader, view);
+      }
+      else if (desc.kind == PLAN::ValueKind::associative) {
+        var = desc.get_target(obj);
+        auto view = var.create_associative_view();
+        ok = read_associative_view(reader, view);
+      }
+      else if (desc.blob) {
+        std::string blob;
+        if (take_blob(reader, blob))
+          var = std::move(blob);
+        ok = !reader.failed();
+      }
+      if (!ok)
+        return false;
+
+      // Only copies (i.e., getter/setter properties) need writing back.
+      if (!PLAN::refers_to_member(var))
+        prop.set_value(obj, var);
+      break;
+    }
+    case NodeKind::object: {
+      if (desc.blob) {
+        std::string blob;
+        if (take_blob(reader, blob))
+          var = std::move(blob);
+        else if (reader.failed())
+          return false;
+      }
+      else {
+        var = desc.get_target(obj);
+        if (desc.type.is_pointer()) {
+          if (auto created = construct(value_t))
+            var = std::move(created);
+        }
+        if (!read_object(reader, var))
+          return false;
+      }
+      if (!PLAN::refers_to_member(var))
+        prop.set_value(obj, var);
+      break;
+    }
+    case NodeKind::binary: {
+      std::string blob;
+      if (desc.blob && take_blob(reader, blob)) {
+        var = std::move(blob);
+        prop.set_value(obj, var);
+      }
+      break;
+    }
+    case NodeKind::null: {
+      prop.set_value(obj, nullptr);
+      break;
+    }
+    case NodeKind::scalar: {
+      TYPE::Scalar &scalar = reader.state.scalar;
+      if (!take_scalar(reader, scalar))
+        return !reader.failed();
+
+      // Typed member access first; anything it cannot store directly goes
+      // through RTTR's conversion.
+      if (desc.store_scalar(obj, scalar))
+        break;
+
+      var = TYPE::decode_scalar_to(scalar, value_t);
+      // REMARK: conversion only works with "const type".
+      if (var.convert(value_t))
+        prop.set_value(obj, var);
+      break;
+    }
+  }
+
+  return !reader.failed();
+}
+
+static bool
+read_object (Reader &reader, ::rttr::instance obj2)
+{
+  ::rttr::instance obj = TYPE::unwrap_instance(obj2);
+  const auto &plan = reader.state.plan(obj.get_derived_type());
+  PROBES::ObjectProbe probe(obj, reader.bytes);
+  TRACE::Scope span(reader.state.trace.get(), obj, reader.bytes);
+  PLAN::MemberTally tally(plan);
+
+  // One pass over the incoming members; unknown members are skipped.
+  std::string_view name;
+  reader.begin_object();
+  while (reader.next_member(name)) {
+    if (const auto desc = tally.visit(name)) {
+      TRACE::Scope member_span(reader.state.trace.get(), *desc, reader.bytes);
+      bool ok = false;
+      try {
+        ok = read_member(reader, *desc, obj);
+      }
+      catch (...) {
+        // e.g., the property's setter rejected the value.
+        reader.fail(ConversionError::exception);
+      }
+      if (!ok)
+        return failed_in_member(reader, desc->key);
+    }
+  }
+
+  reader.result.unknown_members += tally.unknown();
+  if (reader.failed())
+    return false;
+
+  if (const auto missing = tally.first_missing()) {
+    reader.fail(ConversionError::missing_member);
+    return failed_in_member(reader, missing->key);
+  }
+  probe.result(true);
+  return true;
+}
+
+bool
+read (Reader &reader, ::rttr::instance obj)
+{
+  return read_object(reader, obj);
+}
+
+}; // lldc::reflection::engine
@@ -0,0 +1,408 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * The converter-neutral "to" traversal, which grew out of the RTTR
+ * RapidJSON to_json example by way of the JsonGLIB and SocketIO
+ * converters.
+ */
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <lldc-reflection/batch.h>
+#include <lldc-reflection/exceptions/exceptions.h>
+
+#include "private/associative-containers.h"
+#include "private/batch/batch.h"
+#include "private/context/context.h"
+#include "private/engine/engine.h"
+#include "private/plan/plan.h"
+#include "private/probes/probes.h"
+#include "private/trace/trace.h"
+#include "private/type/type.h"
+
+namespace AC = lldc::reflection::associative_containers;
+namespace BATCH = lldc::reflection::batch;
+namespace CONTEXT = lldc::reflection::context;
+namespace PLAN = lldc::reflection::plan;
+namespace PROBES = lldc::reflection::probes;
+namespace TRACE = lldc::reflection::trace;
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::engine {
+
+static bool write_members (const ::rttr::instance &obj2, Writer &writer);
+static bool write_variant (const ::rttr::variant &var, Writer &writer, bool optional = false);
+static bool write_scalar (const TYPE::Scalar &value, Writer &writer, bool optional, bool blob);
+static bool attempt_write_fundamental_type (const ::rttr::type &t, const ::rttr::variant &var, Writer &writer, bool optional = false, bool blob = false);
+static bool write_array (const ::rttr::variant_sequential_view &view, Writer &writer, bool optional = false);
+static bool write_associative_container (const ::rttr::variant_associative_view &view, Writer &writer, bool optional = false);
+static bool write_property (const PLAN::PropertyPlan &desc, const ::rttr::variant &var, Writer &writer, bool optional);
+
+static const std::string KEY = AC::KEY;
+static const std::string VALUE = AC::VALUE;
+
+// The fewest elements worth writing as a separate chunk of a split array,
+// and the most chunks per thread that takes part.
+static const size_t ARRAY_CHUNK_MIN = 256;
+static const size_t ARRAY_CHUNKS_PER_THREAD = 4;
+
+static bool
+write_scalar (const TYPE::Scalar &value, Writer &writer, bool optional, bool blob)
+{
+  if (value.kind == TYPE::ScalarKind::none)
+    return false;
+
+  if (value.kind == TYPE::ScalarKind::string) {
+    if (optional && value.string.empty())
+      return false;
+    writer.bytes += value.string.size();
+    if (blob)
+      return writer.blob(value.string);
+  }
+
+  writer.scalar(value);
+  return true;
+}
+
+// An empty Blob is null, unless it is optional.
+static bool
+write_blob (const Blob &blob, Writer &writer, bool optional)
+{
+  if (!blob.empty())
+    return writer.blob_value(blob);
+  if (optional)
+    return false;
+  writer.null();
+  return true;
+}
+
+// As write_blob, for a shared blob buffer; a null one is like an empty Blob.
+static bool
+write_blob_buffer (const std::shared_ptr<const std::string> &buffer, Writer &writer, bool optional)
+{
+  if (buffer && !(optional && buffer->empty())) {
+    writer.bytes += buffer->size();
+    return writer.blob_buffer(buffer);
+  }
+  if (optional)
+    return false;
+  writer.null();
+  return true;
+}
+
+static bool
+attempt_write_fundamental_type (
+  const ::rttr::type &t,
+  const ::rttr::variant &var,
+  Writer &writer,
+  bool optional,
+  bool blob)
+{
+  bool did_write = false;
+
+  // Number, Boolean, or String
+  if (const auto codec = TYPE::find_scalar_codec(t)) {
+    TYPE::Scalar &value = writer.state.scalar;
+    codec->encode(var, value);
+    did_write = write_scalar(value, writer, optional, blob);
+  }
+  // Enumeration as string
+  else if (t.is_enumeration()) {
+    // Attempt to serialize it as a string
+    TYPE::Scalar &value = writer.state.scalar;
+    bool ok = false;
+    value.string = var.to_string(&ok);
+
+    if (ok && !(optional && value.string.empty())) {
+      value.kind = TYPE::ScalarKind::string;
+      writer.bytes += value.string.size();
+      writer.scalar(value);
+    }
+    else {
+      // Attempt treating as a number
+      value.integer = var.to_int64(&ok);
+      if (ok) {
+        value.kind = TYPE::ScalarKind::integer;
+        value.is_unsigned = false;
+        writer.scalar(value);
+      }
+      else {
+        writer.null();
+      }
+    }
+    did_write = true;
+  }
+
+  return did_write;
+}
+
+/**
+ * @brief Write the array's elements in chunks over the batch pool, each into
+ * a fork of the writer, then join the forks in order.
+ */
+static void
+write_elements_split (const ::rttr::variant_sequential_view &view, Writer &writer, bool optional, size_t size)
+{
+  const size_t chunks = std::min(size / ARRAY_CHUNK_MIN,
+    (BATCH::get_thread_count() + 1) * ARRAY_CHUNKS_PER_THREAD);
+  std::vector<std::unique_ptr<Writer>> forks(chunks);
+  const auto caller = std::this_thread::get_id();
+
+  BATCH::parallel_for(chunks, [&](size_t chunk) {
+    // The calling thread carries on with the writer's own state (nothing in
+    // it is in use across this call); the others use their own.
+    std::optional<CONTEXT::Lease> lease;
+    CONTEXT::State *state = &writer.state;
+    if (std::this_thread::get_id() != caller) {
+      lease.emplace(ConversionContext::this_thread());
+      state = &lease->state();
+    }
+
+    const size_t begin = size * chunk / chunks;
+    const size_t end = size * (chunk + 1) / chunks;
+    auto fork = writer.fork(*state);
+    auto it = view.begin();
+    it += static_cast<int>(begin);
+
+    fork->begin_array();
+    for (size_t i = begin; i < end; i++, ++it) {
+      fork->begin_element();
+      fork->end_element(write_variant(*it, *fork, optional));
+    }
+    fork->end_array();
+    forks[chunk] = std::move(fork);
+  });
+
+  for (auto &fork : forks) {
+    writer.join(*fork);
+    writer.bytes += fork->bytes;
+  }
+}
+
+static bool
+write_array (const ::rttr::variant_sequential_view &view, Writer &writer, bool optional)
+{
+  const size_t size = view.get_size();
+  if (optional && size == 0)
+    return false; // Don't bother serializing.
+
+  writer.begin_array();
+  const size_t threshold = BATCH::get_array_split_threshold();
+  if (threshold && size >= threshold && size >= 2 * ARRAY_CHUNK_MIN &&
+      writer.can_fork() && BATCH::get_thread_count() > 0) {
+    write_elements_split(view, writer, optional, size);
+  }
+  else {
+    for (const auto& item : view) {
+      writer.begin_element();
+      writer.end_element(write_variant(item, writer, optional));
+    }
+  }
+  writer.end_array();
+
+  // Already filtered out "empty" + "optional" = skip; creating an
+  // empty, required array is permissible.
+  return true;
+}
+
+static bool
+write_associative_container (const ::rttr::variant_associative_view &view, Writer &writer, bool optional)
+{
+  if (optional && view.get_size() == 0)
+    return false; // Don't bother serializing.
+
+  writer.begin_array();
+
+  // From the original source code comments:
+  //   "Dealing with keys = values containers like sets"
+  // However the RTTR docs say this method returns TRUE if the
+  // associative container is like a set, where it only contains
+  // keys.
+  if (view.is_key_only_type()) {
+    for (auto& item : view) {
+      writer.begin_element();
+      writer.end_element(write_variant(item.first, writer));
+    }
+  }
+  else {
+    // Original is pretty clearly doing this:
+    //   vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    // [ {'key': <key>, 'value': <value>}, ... ]
+    for (auto& item : view) {
+      writer.begin_element();
+      writer.begin_object();
+
+      writer.begin_member(KEY);
+      bool ok = write_variant(item.first, writer);
+      writer.end_member(ok);
+
+      if (ok) {
+        writer.begin_member(VALUE);
+        ok = write_variant(item.second, writer);
+        writer.end_member(ok);
+      }
+
+      writer.end_object();
+      writer.end_element(ok);
+    }
+  }
+
+  // Inserting an empty associative container is okay because
+  // the container itself is !optional.
+  writer.end_array();
+  return true;
+}
+
+static bool
+write_variant (const ::rttr::variant &var, Writer &writer, bool optional)
+{
+  bool did_write = false;
+
+  // Deal with wrapped type.  Containers and objects are not unwrapped: views
+  // and instances over a wrapper refer to the wrapped value in place, where
+  // extracting it would copy the whole container or object.
+  ::rttr::type varType = var.get_type();
+  const bool wrapped = varType.is_wrapper();
+
+  if (wrapped)
+    varType = varType.get_wrapped_type();
+
+  // If the varType is holding a std::any, it needs to be unpacked.
+  if (TYPE::is_any(varType)) {
+    did_write = write_variant(TYPE::extract_any_value(wrapped ? var.extract_wrapped_value() : var), writer, optional);
+  }
+  else if (varType == ::rttr::type::get<Blob>()) {
+    did_write = write_blob(wrapped ? var.get_wrapped_value<Blob>() : var.get_value<Blob>(), writer, optional);
+  }
+  else if (TYPE::is_fundamental(varType)) {
+    did_write = attempt_write_fundamental_type(varType, wrapped ? var.extract_wrapped_value() : var, writer, optional);
+  }
+  else if (var.is_sequential_container()) {
+    did_write = write_array(var.create_sequential_view(), writer, optional);
+  }
+  else if (var.is_associative_container()) {
+    did_write = write_associative_container(var.create_associative_view(), writer, optional);
+  }
+  else {
+    // Not fundamental or a container -- treat as object.  If nothing is
+    // written and it's optional, the caller discards the unfinished object.
+    writer.begin_object();
+    if (write_members(var, writer)) {
+      writer.end_object();
+      did_write = true;
+    }
+    else if (!optional) {
+      // Source member is "empty" and required.
+      // If it's a pointer-type, represent it as a nullptr
+      // If not, represent it as an empty object.
+      if (varType.is_pointer()) {
+        writer.reset_value();
+        writer.null();
+      }
+      else {
+        writer.end_object();
+      }
+      did_write = true;
+    }
+  }
+
+  return did_write;
+}
+
+static bool
+write_property (const PLAN::PropertyPlan &desc, const ::rttr::variant &var, Writer &writer, bool optional)
+{
+  // The plan already classified the registered type, so unwrapped
+  // fundamentals can skip straight to the scalar.
+  if (desc.kind == PLAN::ValueKind::fundamental && !desc.wrapped)
+    return attempt_write_fundamental_type(desc.type, var, writer, optional, desc.blob);
+  if (desc.kind == PLAN::ValueKind::buffer)
+    return write_blob_buffer(var.get_value<std::shared_ptr<const std::string>>(), writer, optional);
+  return write_variant(var, writer, optional);
+}
+
+static bool
+write_members (const ::rttr::instance &obj2, Writer &writer)
+{
+  bool did_write = false;
+  ::rttr::instance obj = TYPE::unwrap_instance(obj2);
+
+  const auto &plan = writer.state.plan(obj.get_derived_type());
+  PROBES::ObjectProbe probe(obj, writer.bytes);
+  TRACE::Scope span(writer.state.trace.get(), obj, writer.bytes);
+  TYPE::Scalar &scalar = writer.state.scalar;
+  for (const auto &desc : plan.properties)
+  {
+    if (desc.no_serialize) {
+      did_write = true;
+      continue; // skip it.
+    }
+
+    TRACE::Scope member_span(writer.state.trace.get(), desc, writer.bytes);
+
+    bool optional = desc.optional;
+    bool written = false;
+
+    if (desc.load_scalar(obj, scalar)) {
+      // Typed member access; no variant involved.
+      if (optional && desc.has_default) {
+        if (desc.default_scalar == scalar) {
+          did_write = true;
+          continue; // By implication, skip it.
+        }
+        optional = false;
+      }
+
+      writer.begin_property(desc);
+      written = write_scalar(scalar, writer, optional, desc.blob);
+    }
+    else {
+      ::rttr::variant prop_value = desc.get_value(obj);
+
+      if (optional && desc.has_default) {
+        if (desc.default_value == prop_value) {
+          did_write = true;
+          continue; // By implication, skip it.
+        }
+        // Does not match the default, so it must be written.
+        optional = false;
+      }
+
+      if (optional && !prop_value) {
+        did_write = true;
+        continue; // null-like and it's optional; skip it.
+      }
+
+      writer.begin_property(desc);
+      written = write_property(desc, prop_value, writer, optional);
+    }
+
+    writer.end_member(written);
+    if (written) {
+      did_write = true;
+    }
+    else if (!optional) {
+      // Failed write and not optional -> error condition
+      throw exceptions::RequiredMemberSerializationFailure(desc.key);
+    }
+  }
+
+  probe.result(did_write);
+  return did_write;
+}
+
+bool
+write (const ::rttr::instance &obj, Writer &writer)
+{
+  writer.begin_object();
+  if (!write_members(obj, writer))
+    return false;
+  writer.end_object();
+  return true;
+}
+
+}; // lldc::reflection::engine
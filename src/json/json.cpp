@@ -0,0 +1,401 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "private/json/json.h"
+
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::json {
+
+static const char HEX[] = "0123456789abcdef";
+
+void
+append_string (std::string &out, std::string_view value)
+{
+  out += '"';
+
+  // Copy runs of characters that need no escaping in one go.
+  size_t run = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    const unsigned char c = value[i];
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+
+    out.append(value.data() + run, i - run);
+    run = i + 1;
+
+    switch (c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\b': out += "\\b";  break;
+      case '\f': out += "\\f";  break;
+      case '\n': out += "\\n";  break;
+      case '\r': out += "\\r";  break;
+      case '\t': out += "\\t";  break;
+      default:
+        out += "\\u00";
+        out += HEX[c >> 4];
+        out += HEX[c & 0xF];
+        break;
+    }
+  }
+  out.append(value.data() + run, value.size() - run);
+
+  out += '"';
+}
+
+void
+append_integer (std::string &out, int64_t value)
+{
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void
+append_unsigned (std::string &out, uint64_t value)
+{
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void
+append_floating (std::string &out, double value)
+{
+  if (!std::isfinite(value)) {
+    out += "null";
+    return;
+  }
+
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+
+  // Keep it a floating point number when read back (e.g., 500 -> 500.0).
+  if (!std::memchr(buffer, '.', result.ptr - buffer) && !std::memchr(buffer, 'e', result.ptr - buffer))
+    out += ".0";
+}
+
+const char*
+skip_whitespace (const char *p, const char *end)
+{
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+    p++;
+  return p;
+}
+
+static bool
+scan_hex4 (const char *&p, const char *end, uint32_t &value)
+{
+  if (end - p < 4)
+    return false;
+
+  value = 0;
+  for (int i = 0; i < 4; i++, p++) {
+    value <<= 4;
+    if (*p >= '0' && *p <= '9')
+      value |= (*p - '0');
+    else if (*p >= 'a' && *p <= 'f')
+      value |= (*p - 'a' + 10);
+    else if (*p >= 'A' && *p <= 'F')
+      value |= (*p - 'A' + 10);
+    else
+      return false;
+  }
+  return true;
+}
+
+static void
+append_utf8 (std::string &out, uint32_t cp)
+{
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  }
+  else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+bool
+scan_string (const char *&p, const char *end, std::string *out)
+{
+  if (p >= end || *p != '"')
+    return false;
+  p++;
+
+  if (out)
+    out->clear();
+
+  const char *run = p;
+  while (p < end) {
+    const unsigned char c = *p;
+
+    if (c == '"') {
+      if (out)
+        out->append(run, p);
+      p++;
+      return true;
+    }
+
+    if (c < 0x20)
+      return false; // control characters must be escaped.
+
+    if (c != '\\') {
+      p++;
+      continue;
+    }
+
+    if (out)
+      out->append(run, p);
+    if (++p >= end)
+      return false;
+
+    char unescaped = 0;
+    switch (*p++) {
+      case '"':  unescaped = '"';  break;
+      case '\\': unescaped = '\\'; break;
+      case '/':  unescaped = '/';  break;
+      case 'b':  unescaped = '\b'; break;
+      case 'f':  unescaped = '\f'; break;
+      case 'n':  unescaped = '\n'; break;
+      case 'r':  unescaped = '\r'; break;
+      case 't':  unescaped = '\t'; break;
+      case 'u': {
+        uint32_t cp = 0;
+        if (!scan_hex4(p, end, cp))
+          return false;
+
+        // Surrogate pair: a high surrogate must be followed by a low one.
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+          uint32_t low = 0;
+          if (end - p < 2 || p[0] != '\\' || p[1] != 'u')
+            return false;
+          p += 2;
+          if (!scan_hex4(p, end, low) || low < 0xDC00 || low > 0xDFFF)
+            return false;
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+          return false;
+        }
+
+        if (out)
+          append_utf8(*out, cp);
+        run = p;
+        continue;
+      }
+      default:
+        return false;
+    }
+
+    if (out)
+      *out += unescaped;
+    run = p;
+  }
+
+  return false; // unterminated
+}
+
+bool
+scan_key (const char *&p, const char *end, std::string &scratch, std::string_view &key)
+{
+  // Most keys have nothing escaped; those are used where they are.
+  if (p < end && *p == '"') {
+    const char *q = p + 1;
+    while (q < end && *q != '"' && *q != '\\' && static_cast<unsigned char>(*q) >= 0x20)
+      q++;
+    if (q < end && *q == '"') {
+      key = std::string_view(p + 1, q - p - 1);
+      p = q + 1;
+      return true;
+    }
+  }
+
+  if (!scan_string(p, end, &scratch))
+    return false;
+  key = scratch;
+  return true;
+}
+
+bool
+scan_number (const char *&p, const char *end, TYPE::Scalar *out)
+{
+  const char *start = p;
+  bool integral = true;
+
+  if (p < end && *p == '-')
+    p++;
+
+  // Integer part: 0, or a non-zero digit followed by digits.
+  if (p >= end || *p < '0' || *p > '9')
+    return false;
+  if (*p == '0')
+    p++;
+  else
+    while (p < end && *p >= '0' && *p <= '9')
+      p++;
+
+  if (p < end && *p == '.') {
+    integral = false;
+    p++;
+    if (p >= end || *p < '0' || *p > '9')
+      return false;
+    while (p < end && *p >= '0' && *p <= '9')
+      p++;
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    integral = false;
+    p++;
+    if (p < end && (*p == '+' || *p == '-'))
+      p++;
+    if (p >= end || *p < '0' || *p > '9')
+      return false;
+    while (p < end && *p >= '0' && *p <= '9')
+      p++;
+  }
+
+  if (!out)
+    return true;
+
+  if (integral) {
+    int64_t value = 0;
+    auto result = std::from_chars(start, p, value);
+    if (result.ec == std::errc() && result.ptr == p) {
+      out->kind = TYPE::ScalarKind::integer;
+      out->integer = value;
+      out->is_unsigned = false;
+      return true;
+    }
+
+    // Above INT64_MAX; carried by bit pattern like any other unsigned.
+    uint64_t uvalue = 0;
+    result = std::from_chars(start, p, uvalue);
+    if (result.ec == std::errc() && result.ptr == p) {
+      out->kind = TYPE::ScalarKind::integer;
+      out->integer = static_cast<int64_t>(uvalue);
+      out->is_unsigned = true;
+      return true;
+    }
+  }
+
+  double value = 0.0;
+  auto result = std::from_chars(start, p, value);
+  if (result.ptr != p)
+    return false;
+
+  // Out of range values are rounded to zero or infinity by from_chars.
+  out->kind = TYPE::ScalarKind::floating;
+  out->floating = value;
+  return true;
+}
+
+static bool
+scan_literal (const char *&p, const char *end, const char *literal)
+{
+  const size_t length = std::strlen(literal);
+  if (static_cast<size_t>(end - p) < length || std::memcmp(p, literal, length) != 0)
+    return false;
+  p += length;
+  return true;
+}
+
+bool
+skip_value (const char *&p, const char *end, unsigned depth)
+{
+  p = skip_whitespace(p, end);
+  if (p >= end)
+    return false;
+
+  switch (*p) {
+    case '{': {
+      if (++depth > MAX_DEPTH)
+        return false;
+      p = skip_whitespace(p + 1, end);
+      if (p < end && *p == '}') {
+        p++;
+        return true;
+      }
+      while (true) {
+        p = skip_whitespace(p, end);
+        if (!scan_string(p, end, nullptr))
+          return false;
+        p = skip_whitespace(p, end);
+        if (p >= end || *p++ != ':')
+          return false;
+        if (!skip_value(p, end, depth))
+          return false;
+        p = skip_whitespace(p, end);
+        if (p >= end)
+          return false;
+        if (*p == '}') {
+          p++;
+          return true;
+        }
+        if (*p++ != ',')
+          return false;
+      }
+    }
+    case '[': {
+      if (++depth > MAX_DEPTH)
+        return false;
+      p = skip_whitespace(p + 1, end);
+      if (p < end && *p == ']') {
+        p++;
+        return true;
+      }
+      while (true) {
+        if (!skip_value(p, end, depth))
+          return false;
+        p = skip_whitespace(p, end);
+        if (p >= end)
+          return false;
+        if (*p == ']') {
+          p++;
+          return true;
+        }
+        if (*p++ != ',')
+          return false;
+      }
+    }
+    case '"':
+      return scan_string(p, end, nullptr);
+    case 't':
+      return scan_literal(p, end, "true");
+    case 'f':
+      return scan_literal(p, end, "false");
+    case 'n':
+      return scan_literal(p, end, "null");
+    default:
+      return scan_number(p, end, nullptr);
+  }
+}
+
+bool
+is_valid (std::string_view text)
+{
+  const char *p = text.data();
+  const char *end = p + text.size();
+  return skip_value(p, end) && skip_whitespace(p, end) == end;
+}
+
+}; // lldc::reflection::json
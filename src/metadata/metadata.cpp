@@ -11,6 +11,7 @@ const char* const OPTIONAL = "OPTIONAL";
 const char* const OPTIONAL_DEFAULT = "OPTIONAL_DEFAULT";
 const char* const NO_SERIALIZE = "NO_SERIALIZE";
 const char* const BLOB = "BLOB";
+const char* const MEMBER_ACCESS = "MEMBER_ACCESS";
 
 ::rttr::detail::metadata
 set_is_optional() {
@@ -32,6 +33,11 @@ set_is_blob() {
   return ::rttr::metadata(BLOB, true);
 }
 
+::rttr::detail::metadata
+detail::set_member_access(std::shared_ptr<const MemberAccess> access) {
+  return ::rttr::metadata(MEMBER_ACCESS, access);
+}
+
 bool
 is_optional(const ::rttr::property &property, bool *with_default) {
   bool result = false;
@@ -81,4 +87,12 @@ is_no_serialize(const ::rttr::property &property) {
   return false;
 }
 
+std::shared_ptr<const MemberAccess>
+get_member_access(const ::rttr::property &property) {
+  auto md = property.get_metadata(metadata::MEMBER_ACCESS);
+  if (md.is_type<std::shared_ptr<const MemberAccess>>())
+    return md.get_value<std::shared_ptr<const MemberAccess>>();
+  return nullptr;
+}
+
 }; // lldc::reflection::metadata
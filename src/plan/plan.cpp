@@ -0,0 +1,446 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <lldc-reflection/blob.h>
+
+#include "private/json/json.h"
+#include "private/metadata/metadata.h"
+#include "private/plan/plan.h"
+#include "private/type/type.h"
+
+namespace JSON = lldc::reflection::json;
+namespace METADATA = lldc::reflection::metadata;
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::plan {
+
+static ::rttr::type
+unwrap (const ::rttr::type &t)
+{
+  return t.is_wrapper() ? t.get_wrapped_type() : t;
+}
+
+static ValueKind
+classify (const ::rttr::type &t)
+{
+  if (TYPE::is_any(t))
+    return ValueKind::any;
+  if (t == ::rttr::type::get<::lldc::reflection::Blob>())
+    return ValueKind::blob;
+  if (TYPE::is_fundamental(t))
+    return ValueKind::fundamental;
+  if (t.is_sequential_container())
+    return ValueKind::sequential;
+  if (t.is_associative_container())
+    return ValueKind::associative;
+  return ValueKind::object;
+}
+
+PropertyPlan::PropertyPlan(const ::rttr::property &prop) :
+  property(prop),
+  type(unwrap(prop.get_type())),
+  wrapped(prop.get_type().is_wrapper()),
+  kind(classify(type)),
+  optional(false),
+  has_default(false),
+  default_value(),
+  no_serialize(METADATA::is_no_serialize(prop)),
+  blob(METADATA::is_blob(prop)),
+  scalar_codec(nullptr),
+  key(prop.get_name().to_string()),
+  key_rank(0)
+{
+  JSON::append_string(json_key, key);
+  json_key += ':';
+
+  // A wrapped Blob (e.g., std::shared_ptr<Blob>) is not one by value.
+  if (kind == ValueKind::blob && wrapped)
+    kind = ValueKind::object;
+
+  // Shared blob buffers are handed to (and taken from) the converters as
+  // they are, so large blobs are not copied.
+  if (blob && prop.get_type() == ::rttr::type::get<std::shared_ptr<const std::string>>())
+    kind = ValueKind::buffer;
+
+  optional = METADATA::is_optional(prop, &has_default);
+  if (has_default)
+    default_value = prop.get_metadata(METADATA::OPTIONAL_DEFAULT);
+
+  // Pointers already refer to their object, so only by-value members are
+  // accessed directly.
+  const bool by_value = (!wrapped && !type.is_pointer());
+  if (!by_value || kind == ValueKind::any || kind == ValueKind::blob)
+    return;
+
+  auto member = METADATA::get_member_access(prop);
+  if (!member)
+    return;
+
+  // Only when the access really is to a member of this type, declared by
+  // the property's class (or a base of it); otherwise the property is read
+  // and written through RTTR as usual.
+  const auto declaring = prop.get_declaring_type();
+  const auto member_class = member->declaring_type();
+  if (member->member_type() != type ||
+      !(declaring == member_class || declaring.is_derived_from(member_class)))
+    return;
+
+  if (kind != ValueKind::fundamental) {
+    access = member;
+    return;
+  }
+
+  if (type.is_enumeration()) {
+    const auto enumeration = type.get_enumeration();
+    const auto underlying = enumeration.get_underlying_type();
+    scalar_codec = TYPE::find_scalar_codec(underlying);
+    if (scalar_codec) {
+      for (const auto &value : enumeration.get_values()) {
+        TYPE::Scalar loaded;
+        ::rttr::variant as_underlying = value;
+        if (as_underlying.convert(underlying)) {
+          scalar_codec->encode(as_underlying, loaded);
+          enumerators.emplace_back(loaded.integer, enumeration.value_to_name(value).to_string());
+        }
+      }
+    }
+  }
+  else {
+    scalar_codec = TYPE::find_scalar_codec(type);
+  }
+
+  if (scalar_codec && has_default) {
+    // The comparison is done on the loaded scalars, so the default must be
+    // of the member's own type; anything else is left to the variant path.
+    if (default_value.get_type() != type) {
+      scalar_codec = nullptr;
+    }
+    else if (type.is_enumeration()) {
+      ::rttr::variant as_underlying = default_value;
+      if (as_underlying.convert(type.get_enumeration().get_underlying_type())) {
+        scalar_codec->encode(as_underlying, default_scalar);
+        name_enumerator(default_scalar);
+      }
+      else {
+        scalar_codec = nullptr;
+      }
+    }
+    else {
+      scalar_codec->encode(default_value, default_scalar);
+    }
+  }
+
+  if (scalar_codec)
+    access = member;
+}
+
+void
+PropertyPlan::name_enumerator (TYPE::Scalar &value) const
+{
+  for (const auto &enumerator : enumerators) {
+    if (enumerator.first == value.integer) {
+      value.kind = TYPE::ScalarKind::string;
+      value.string = enumerator.second;
+      return;
+    }
+  }
+  // Not a registered enumerator; left as the number.
+}
+
+bool
+PropertyPlan::load_scalar (const ::rttr::instance &obj, TYPE::Scalar &out) const
+{
+  if (!scalar_codec)
+    return false;
+
+  const void *src = access->address(obj);
+  if (!src)
+    return false;
+
+  scalar_codec->load(src, out);
+  if (type.is_enumeration())
+    name_enumerator(out);
+  return true;
+}
+
+bool
+PropertyPlan::store_scalar (const ::rttr::instance &obj, TYPE::Scalar &in) const
+{
+  if (!scalar_codec)
+    return false;
+
+  void *dst = access->address(obj);
+  if (!dst)
+    return false;
+
+  if (!type.is_enumeration())
+    return scalar_codec->store(in, dst);
+
+  // Enumerations arrive by name; numbers are left to RTTR's conversion.
+  if (in.kind != TYPE::ScalarKind::string)
+    return false;
+
+  for (const auto &enumerator : enumerators) {
+    if (enumerator.second == in.string) {
+      TYPE::Scalar value;
+      value.kind = TYPE::ScalarKind::integer;
+      value.integer = enumerator.first;
+      return scalar_codec->store(value, dst);
+    }
+  }
+  return false;
+}
+
+::rttr::variant
+PropertyPlan::get_value (const ::rttr::instance &obj) const
+{
+  // Comparing a reference against the registered default is not reliable,
+  // so those members are still read by value when encoding.
+  if (has_default)
+    return property.get_value(obj);
+  return get_target(obj);
+}
+
+::rttr::variant
+PropertyPlan::get_target (const ::rttr::instance &obj) const
+{
+  if (access && kind != ValueKind::fundamental) {
+    auto ref = access->reference(obj);
+    if (ref.is_valid())
+      return ref;
+  }
+  return property.get_value(obj);
+}
+
+// Upper bound on the displacements tried for a single bucket before the
+// table is grown, and on the table size (relative to the key count) before
+// giving up on the perfect hash altogether.
+static const uint32_t MAX_DISPLACEMENT = 1 << 12;
+static const size_t MAX_TABLE_FACTOR = 16;
+
+static uint64_t
+hash_key (std::string_view key)
+{
+  // FNV-1a
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : key) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+static uint64_t
+displace (uint64_t h, uint32_t d)
+{
+  // splitmix64 finalizer over the displaced hash
+  uint64_t x = h + (static_cast<uint64_t>(d) * 0x9e3779b97f4a7c15ULL);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * @brief Attempt a hash-and-displace layout of the keys into a table of the
+ * given size.  Buckets are placed largest first, each searching for the first
+ * displacement that lands all of its keys on free, distinct slots.
+ */
+static bool
+try_build_index (
+  TypePlan &plan,
+  const std::vector<std::pair<uint64_t, int32_t>> &keys,
+  size_t bucket_count,
+  size_t table_size)
+{
+  std::vector<std::vector<size_t>> buckets(bucket_count);
+  for (size_t i = 0; i < keys.size(); i++)
+    buckets[keys[i].first % bucket_count].push_back(i);
+
+  std::vector<size_t> order(bucket_count);
+  for (size_t i = 0; i < bucket_count; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+    return buckets[lhs].size() > buckets[rhs].size();
+  });
+
+  plan.displacements.assign(bucket_count, 0);
+  plan.slots.assign(table_size, -1);
+
+  std::vector<size_t> candidate;
+  for (auto b : order) {
+    const auto &bucket = buckets[b];
+    if (bucket.empty())
+      break; // sorted; the rest are empty too.
+
+    bool placed = false;
+    for (uint32_t d = 0; d < MAX_DISPLACEMENT && !placed; d++) {
+      candidate.clear();
+      placed = true;
+      for (auto k : bucket) {
+        size_t slot = displace(keys[k].first, d) % table_size;
+        if (plan.slots[slot] != -1 || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+          placed = false;
+          break;
+        }
+        candidate.push_back(slot);
+      }
+
+      if (placed) {
+        for (size_t i = 0; i < bucket.size(); i++)
+          plan.slots[candidate[i]] = keys[bucket[i]].second;
+        plan.displacements[b] = d;
+      }
+    }
+
+    if (!placed)
+      return false;
+  }
+
+  return true;
+}
+
+static void
+build_index (TypePlan &plan)
+{
+  // If a name is registered more than once (e.g., by a base and derived
+  // class), the first registration in the property list wins.
+  std::vector<std::pair<uint64_t, int32_t>> keys;
+  for (size_t i = 0; i < plan.properties.size(); i++) {
+    const auto &key = plan.properties[i].key;
+    bool duplicate = std::any_of(keys.begin(), keys.end(), [&](const auto &k) {
+      return plan.properties[k.second].key == key;
+    });
+    if (!duplicate)
+      keys.emplace_back(hash_key(key), static_cast<int32_t>(i));
+  }
+
+  if (keys.empty())
+    return;
+
+  const size_t bucket_count = std::max<size_t>(1, keys.size() / 2);
+  for (size_t table_size = keys.size() + keys.size() / 4 + 1;
+       table_size <= keys.size() * MAX_TABLE_FACTOR;
+       table_size += table_size / 2 + 1)
+  {
+    if (try_build_index(plan, keys, bucket_count, table_size))
+      return;
+  }
+
+  // Unable to separate the keys; find() falls back to a linear search.
+  plan.displacements.clear();
+  plan.slots.clear();
+}
+
+static void
+rank_keys (TypePlan &plan)
+{
+  std::vector<uint32_t> order(plan.properties.size());
+  for (uint32_t i = 0; i < order.size(); i++)
+    order[i] = i;
+
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    const auto &key_a = plan.properties[a].key, &key_b = plan.properties[b].key;
+    return (key_a != key_b) ? key_a < key_b : a < b;
+  });
+
+  for (uint32_t rank = 0; rank < order.size(); rank++)
+    plan.properties[order[rank]].key_rank = rank;
+}
+
+const PropertyPlan*
+TypePlan::find (std::string_view key) const
+{
+  if (slots.empty()) {
+    for (const auto &desc : properties) {
+      if (desc.key == key)
+        return &desc;
+    }
+    return nullptr;
+  }
+
+  const uint64_t h = hash_key(key);
+  const int32_t index = slots[displace(h, displacements[h % displacements.size()]) % slots.size()];
+  if (index < 0 || properties[index].key != key)
+    return nullptr;
+  return &properties[index];
+}
+
+MemberTally::MemberTally(const TypePlan &plan) :
+  _plan(plan),
+  _unknown(0),
+  _inline_bits{},
+  _heap_bits(),
+  _bits(_inline_bits.data())
+{
+  const size_t words = (plan.properties.size() + 63) / 64;
+  if (words > _inline_bits.size()) {
+    _heap_bits.assign(words, 0);
+    _bits = _heap_bits.data();
+  }
+}
+
+const PropertyPlan*
+MemberTally::visit (std::string_view key)
+{
+  const PropertyPlan *desc = _plan.find(key);
+  if (!desc) {
+    _unknown++;
+    return nullptr;
+  }
+
+  const size_t i = desc - _plan.properties.data();
+  _bits[i / 64] |= (uint64_t{1} << (i % 64));
+  return desc;
+}
+
+const PropertyPlan*
+MemberTally::first_missing () const
+{
+  for (size_t i = 0; i < _plan.properties.size(); i++) {
+    const auto &desc = _plan.properties[i];
+    if (desc.optional)
+      continue;
+    if (_bits[i / 64] & (uint64_t{1} << (i % 64)))
+      continue;
+    // Shadowed duplicates are never visited; only report the property
+    // the name actually resolves to.
+    if (_plan.find(desc.key) == &desc)
+      return &desc;
+  }
+  return nullptr;
+}
+
+static std::shared_mutex plans_lock;
+static std::unordered_map<::rttr::type::type_id, std::unique_ptr<TypePlan>> plans;
+
+const TypePlan&
+get_type_plan (const ::rttr::type &t)
+{
+  {
+    std::shared_lock<std::shared_mutex> lock(plans_lock);
+    if (const auto it = plans.find(t.get_id()); it != plans.cend())
+      return *it->second;
+  }
+
+  auto plan = std::make_unique<TypePlan>();
+  for (const auto& prop : t.get_properties())
+    plan->properties.emplace_back(prop);
+  build_index(*plan);
+  rank_keys(*plan);
+
+  // Another thread may have built the same plan in the meantime; keep
+  // whichever landed first so references handed out remain valid.
+  std::unique_lock<std::shared_mutex> lock(plans_lock);
+  auto result = plans.emplace(t.get_id(), std::move(plan));
+  return *result.first->second;
+}
+
+}; // lldc::reflection::plan
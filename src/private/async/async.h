@@ -0,0 +1,95 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for the background encoder threads behind the *_async
+ * converters.  Each encoder thread drains its own intrusive MPSC queue
+ * (Vyukov's): queuing is an allocation, an atomic exchange and a wake-up,
+ * so producers never wait on a lock or on a conversion.
+ */
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include <rttr/registration>
+
+namespace lldc::reflection::async {
+
+struct Task {
+  virtual ~Task() = default;
+  virtual void run() = 0;
+
+  std::atomic<Task*> next = nullptr;
+};
+
+/**
+ * @brief Queue the task on the next encoder thread (round-robin), which
+ * runs and then deletes it.
+ */
+void submit(std::unique_ptr<Task> task);
+
+template <typename F>
+struct FunctionTask : public Task {
+  explicit FunctionTask(F &&f) : f(std::move(f)) {}
+  void run() override { f(); }
+  F f;
+};
+
+/**
+ * @brief Queue convert(instance) for the object held by the variant, with
+ * its result (or exception) going to the returned future.
+ */
+template <typename R, typename Convert>
+std::future<R>
+queue_conversion (::rttr::variant object, Convert convert)
+{
+  std::promise<R> promise;
+  auto future = promise.get_future();
+
+  auto run = [object = std::move(object), convert, promise = std::move(promise)] () mutable {
+    try {
+      promise.set_value(convert(::rttr::instance(object)));
+    }
+    catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  };
+  submit(std::make_unique<FunctionTask<decltype(run)>>(std::move(run)));
+  return future;
+}
+
+/**
+ * @brief As above, passing the result (or exception) to 'done' on the
+ * encoder thread.  Anything 'done' throws is dropped.
+ */
+template <typename R, typename Convert>
+void
+queue_conversion (::rttr::variant object, Convert convert, std::function<void (R, std::exception_ptr)> done)
+{
+  auto run = [object = std::move(object), convert, done = std::move(done)] () mutable {
+    R result {};
+    std::exception_ptr error;
+    try {
+      result = convert(::rttr::instance(object));
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+
+    try {
+      if (done)
+        done(std::move(result), error);
+    }
+    catch (...) {
+      // Nobody to tell.
+    }
+  };
+  submit(std::make_unique<FunctionTask<decltype(run)>>(std::move(run)));
+}
+
+}; // lldc::reflection::async
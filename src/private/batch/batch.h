@@ -0,0 +1,66 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for the worker pool behind the batch converters.  A batch
+ * is split into one contiguous share of indices per participating thread
+ * (the workers that join it and the calling thread, which always takes
+ * part, so a batch completes even if every worker is busy).  A thread that
+ * runs out of work steals the back half of the largest remaining share.
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace lldc::reflection::batch {
+
+/**
+ * @brief Run body(i) for each i in [0, count), spread over the pool, and
+ * return once all have run.  If any throw, the exception of the lowest such
+ * index is rethrown here (the rest of the indices are still run).
+ * @param grain the number of indices a thread takes from its share at once
+ */
+void parallel_for(size_t count, const std::function<void (size_t)> &body, size_t grain = 1);
+
+/**
+ * @brief Run convert(i) for each i in [0, count) with parallel_for and
+ * return the results in order.  If any throw, release(result) is called for
+ * every result (default-constructed where none was stored) before the
+ * exception is rethrown.
+ */
+template <typename Result, typename Convert, typename Release>
+std::vector<Result>
+run_conversions (size_t count, const Convert &convert, const Release &release)
+{
+  // Not std::vector<bool>, whose elements cannot be set from separate threads.
+  using Slot = std::conditional_t<std::is_same_v<Result, bool>, char, Result>;
+  std::vector<Slot> out(count, Slot());
+
+  try {
+    parallel_for(count, [&](size_t i) {
+      out[i] = convert(i);
+    });
+  }
+  catch (...) {
+    for (auto &result : out)
+      release(result);
+    throw;
+  }
+
+  if constexpr (std::is_same_v<Result, bool>)
+    return std::vector<bool>(out.begin(), out.end());
+  else
+    return out;
+}
+
+template <typename Result, typename Convert>
+std::vector<Result>
+run_conversions (size_t count, const Convert &convert)
+{
+  return run_conversions<Result>(count, convert, [](const auto &) {});
+}
+
+}; // lldc::reflection::batch
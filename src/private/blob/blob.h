@@ -0,0 +1,57 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for what a Blob holds.  Each converter that can keep its
+ * own representation of a blob (e.g., the JsonNode it read) derives from
+ * Value, and its writer looks for that first, with dynamic_cast, before
+ * falling back to the text.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <rttr/registration>
+#include <lldc-reflection/blob.h>
+#include <lldc-reflection/context.h>
+
+namespace lldc::reflection::blob {
+
+struct Value {
+  virtual ~Value() = default;
+
+  // Append the value as compact JSON text.
+  virtual void append_text(std::string &out) const = 0;
+
+  virtual bool decode(::rttr::instance obj, ConversionContext &context) const = 0;
+};
+
+/**
+ * @brief JSON text: either given (and so checked before it is written) or
+ * read by the native JSON converter (and so known to be well-formed).
+ */
+struct TextValue : public Value {
+  TextValue(std::string text, bool checked) : text(std::move(text)), checked(checked) {}
+
+  void append_text(std::string &out) const override;
+  bool decode(::rttr::instance obj, ConversionContext &context) const override;
+
+  const std::string text;
+  const bool checked;
+};
+
+/**
+ * @brief JSON text in a shared buffer (e.g., a socket.io binary message's),
+ * which is not copied.
+ */
+struct BufferValue : public Value {
+  explicit BufferValue(std::shared_ptr<const std::string> buffer) : buffer(std::move(buffer)) {}
+
+  void append_text(std::string &out) const override;
+  bool decode(::rttr::instance obj, ConversionContext &context) const override;
+
+  const std::shared_ptr<const std::string> buffer;
+};
+
+}; // lldc::reflection::blob
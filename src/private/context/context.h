@@ -0,0 +1,75 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for what a ConversionContext holds.  Everything here is
+ * only ever touched by the one thread using the context, so nothing is
+ * locked; see lldc-reflection/context.h for the contract.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <rttr/registration>
+#include <lldc-reflection/context.h>
+
+#include "private/plan/plan.h"
+#include "private/trace/trace.h"
+#include "private/type/type.h"
+
+namespace lldc::reflection::context {
+
+struct State {
+  /**
+   * @brief As plan::get_type_plan, answered from this context's own cache
+   * once the type has been seen, so the shared lock is not taken again.
+   */
+  const ::lldc::reflection::plan::TypePlan& plan(const ::rttr::type &t);
+
+  /**
+   * @brief Drop any scratch buffer that grew past what a typical message
+   * needs, so one huge message does not pin its memory to the thread.
+   */
+  void trim();
+
+  std::unordered_map<::rttr::type::type_id, const ::lldc::reflection::plan::TypePlan*> plans;
+
+  // Holds one scalar at a time, between reading it and storing/writing it.
+  ::lldc::reflection::type::Scalar scalar;
+
+  // Chunk of text being written (JSON) before it is handed to the sink.
+  std::string buffer;
+
+  // Unescaped member name (JSON reader).
+  std::string key;
+
+  // The spans being recorded, while tracing (see lldc-reflection/trace.h).
+  std::unique_ptr<::lldc::reflection::trace::Recorder> trace;
+
+  // Set while a conversion is using this state.
+  bool busy = false;
+};
+
+/**
+ * @brief The state for one conversion: the context's own, or, when that is
+ * already busy (a conversion started while another is running on this
+ * thread, e.g. from a property's setter), a temporary one.
+ */
+class Lease {
+public:
+  explicit Lease(ConversionContext &context);
+  ~Lease();
+
+  Lease(const Lease&) = delete;
+  Lease& operator=(const Lease&) = delete;
+
+  State& state() { return *_state; }
+
+private:
+  State *_state;
+  std::unique_ptr<State> _temporary;
+};
+
+}; // lldc::reflection::context
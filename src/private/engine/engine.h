@@ -0,0 +1,248 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for the reflective traversal shared by all converters.
+ * The engine walks the RTTR instance (using the per-type plans) and drives
+ * a Writer, or is driven by a Reader, so a converter only has to map those
+ * calls onto its own representation (JsonNode, sio::message, etc.).  The
+ * optional/default/blob and required-member semantics live here, once.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <rttr/registration>
+#include <lldc-reflection/blob.h>
+#include <lldc-reflection/result.h>
+
+#include "private/context/context.h"
+#include "private/plan/plan.h"
+#include "private/type/type.h"
+
+namespace lldc::reflection::engine {
+
+/**
+ * @brief Output side of a converter.  Values are written into "slots": the
+ * root slot, which exists from the start, and one slot per object member or
+ * array element opened with begin_member/begin_element.  Exactly one value
+ * (a scalar, null, blob, or an object/array with its contents) is written
+ * into each slot.
+ */
+class Writer {
+public:
+  explicit Writer(::lldc::reflection::context::State &state) : state(state) {}
+  virtual ~Writer() = default;
+
+  virtual void begin_object() = 0;
+  virtual void end_object() = 0;
+  virtual void begin_array() = 0;
+  virtual void end_array() = 0;
+
+  /**
+   * @brief Open a slot for a member of the enclosing object.  The key must
+   * remain valid until the matching end_member.
+   */
+  virtual void begin_member(const std::string &key) = 0;
+
+  /**
+   * @brief As begin_member, for a registered property, so writers can use
+   * what the plan has prepared for it (e.g., its pre-escaped JSON key).
+   */
+  virtual void begin_property(const ::lldc::reflection::plan::PropertyPlan &desc) {
+    begin_member(desc.key);
+  }
+
+  /**
+   * @brief Close the member's slot.  If 'keep' is false, whatever was written
+   * into it, including any object or array left unfinished, is discarded.
+   */
+  virtual void end_member(bool keep) = 0;
+
+  // As begin_member/end_member, for an element of the enclosing array.
+  virtual void begin_element() = 0;
+  virtual void end_element(bool keep) = 0;
+
+  /**
+   * @brief Discard whatever was written into the innermost open slot,
+   * including unfinished objects and arrays, so another value can be written.
+   */
+  virtual void reset_value() = 0;
+
+  virtual void scalar(const ::lldc::reflection::type::Scalar &value) = 0;
+  virtual void null() = 0;
+
+  /**
+   * @brief Write a blob (see metadata::set_is_blob) in the converter's own
+   * representation.  Returns false, writing nothing, if that is not possible.
+   */
+  virtual bool blob(const std::string &value) = 0;
+
+  /**
+   * @brief Write a Blob, preferably as what the converter itself read (see
+   * private/blob/blob.h); by default, as its text.  An empty Blob is not
+   * passed here.
+   */
+  virtual bool blob_value(const ::lldc::reflection::Blob &value) {
+    return blob(value.text());
+  }
+
+  /**
+   * @brief Write a shared blob buffer (never null); converters that can
+   * keep a reference to it rather than copy it should.
+   */
+  virtual bool blob_buffer(const std::shared_ptr<const std::string> &value) {
+    return blob(*value);
+  }
+
+  /**
+   * @brief True if fork() and join() are implemented, so a large array can
+   * be written in chunks on several threads.
+   */
+  virtual bool can_fork() const { return false; }
+
+  /**
+   * @brief A new writer for a run of the elements of the array being
+   * written, using the given state, on another thread.  Its root slot is
+   * written as an array holding just those elements.  This writer is only
+   * read, so several threads may fork it at the same time.
+   */
+  virtual std::unique_ptr<Writer> fork(::lldc::reflection::context::State &) const { return nullptr; }
+
+  /**
+   * @brief Append the elements of the (completed) fork to the array being
+   * written, as if they had been written here.
+   */
+  virtual void join(Writer &) {}
+
+  // The conversion's scratch buffers and caches.
+  ::lldc::reflection::context::State &state;
+
+  // String and blob bytes written so far (counted by the engine, for stats).
+  size_t bytes = 0;
+};
+
+/**
+ * @brief What the Reader's current value is.
+ */
+enum class NodeKind {
+  null,
+  scalar,
+  binary,
+  array,
+  object
+};
+
+/**
+ * @brief Input side of a converter: a cursor over the incoming message.  The
+ * "current value" is initially the root and then whatever the last
+ * next_member/next_element moved to.  A value that is not read (or entered)
+ * before moving on is skipped.
+ */
+class Reader {
+public:
+  explicit Reader(::lldc::reflection::context::State &state) : state(state) {}
+  virtual ~Reader() = default;
+
+  virtual NodeKind kind() const = 0;
+
+  /**
+   * @brief The number of elements in the current array value, if known up
+   * front, otherwise 0.
+   */
+  virtual size_t size_hint() const = 0;
+
+  /**
+   * @brief Enter the current (object) value.  Each next_member then moves to
+   * the next member's value, setting 'key' to its name (valid until the next
+   * call on the reader), and returns false after the last member.
+   */
+  virtual void begin_object() = 0;
+  virtual bool next_member(std::string_view &key) = 0;
+
+  // As begin_object/next_member, for the elements of an array value.
+  virtual void begin_array() = 0;
+  virtual bool next_element() = 0;
+
+  /**
+   * @brief Read the current scalar value.  Returns false if it is not one
+   * the converters can represent.
+   */
+  virtual bool read_scalar(::lldc::reflection::type::Scalar &out) = 0;
+
+  /**
+   * @brief Read the current value as a blob (see metadata::set_is_blob) in
+   * its string form.  Returns false if that is not possible.
+   */
+  virtual bool read_blob(std::string &out) = 0;
+
+  /**
+   * @brief Read the current value as a Blob, keeping whatever the converter
+   * can splice back in or decode from later; by default, read_blob's text.
+   */
+  virtual bool read_blob_value(::lldc::reflection::Blob &out) {
+    std::string text;
+    if (!read_blob(text))
+      return false;
+    out = ::lldc::reflection::Blob(std::move(text));
+    return true;
+  }
+
+  /**
+   * @brief As read_blob, into a shared buffer, which converters that hold
+   * the blob in one already hand over without copying.
+   */
+  virtual bool read_blob_buffer(std::shared_ptr<const std::string> &out) {
+    auto text = std::make_shared<std::string>();
+    if (!read_blob(*text))
+      return false;
+    out = std::move(text);
+    return true;
+  }
+
+  /**
+   * @brief Record why reading failed, unless a failure is already recorded.
+   * A reader that fails (e.g., on malformed input) must then behave as if
+   * its input had ended: no more members or elements, nothing to read.
+   */
+  void fail(::lldc::reflection::ConversionError error) {
+    if (!failed())
+      result.error = error;
+  }
+
+  bool failed() const {
+    return result.error != ::lldc::reflection::ConversionError::none;
+  }
+
+  // The conversion's scratch buffers and caches.
+  ::lldc::reflection::context::State &state;
+
+  // String and blob bytes read so far (counted by the engine, for stats).
+  size_t bytes = 0;
+
+  // The outcome, with the path filled in by the engine.
+  ::lldc::reflection::ConversionResult result;
+};
+
+/**
+ * @brief Write the object's registered properties to the writer's current
+ * slot as an object.
+ * @return false if nothing was written, in which case the slot should be
+ * discarded.
+ * @throws exceptions::RequiredMemberSerializationFailure
+ */
+bool write(const ::rttr::instance &obj, Writer &writer);
+
+/**
+ * @brief Read the reader's current value, which must be an object, into
+ * the registered properties of obj.  Failures (missing required members,
+ * or any the reader records) are reported in reader.result, without
+ * throwing; only what the properties themselves throw is passed on.
+ * @return false if it failed, in which case obj may be partly updated.
+ */
+bool read(Reader &reader, ::rttr::instance obj);
+
+}; // lldc::reflection::engine
@@ -0,0 +1,44 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header shared by the json-glib converter's sources.
+ */
+#pragma once
+
+#include <string>
+
+#include <json-glib/json-glib.h>
+#include <lldc-reflection/converters/json-glib.h>
+
+#include "private/blob/blob.h"
+
+namespace lldc::reflection::converters {
+
+/**
+ * @brief A blob read by from_json_glib: a reference to the node itself, so
+ * it can be written back (as a shallow copy) or decoded without going
+ * through text.
+ */
+struct JsonGlibBlobValue : public ::lldc::reflection::blob::Value {
+  explicit JsonGlibBlobValue(JsonNode *node) : node(json_node_ref(node)) {}
+  ~JsonGlibBlobValue() override { json_node_unref(node); }
+
+  JsonGlibBlobValue(const JsonGlibBlobValue&) = delete;
+  JsonGlibBlobValue& operator=(const JsonGlibBlobValue&) = delete;
+
+  void append_text(std::string &out) const override {
+    auto text = json_to_string(node, FALSE);
+    if (text)
+      out += text;
+    g_free(text);
+  }
+
+  bool decode(::rttr::instance obj, ConversionContext &context) const override {
+    return from_json_glib(node, obj, context);
+  }
+
+  JsonNode *node;
+};
+
+}; // lldc::reflection::converters
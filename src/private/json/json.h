@@ -0,0 +1,73 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for formatting and scanning JSON text, used by the
+ * native JSON converter (and by the plans, to pre-escape member keys).
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "private/type/type.h"
+
+namespace lldc::reflection::json {
+
+/**
+ * @brief Append the value as a JSON string: quoted, with quotes, backslashes
+ * and control characters escaped.  Other bytes (i.e., UTF-8) are copied.
+ */
+void append_string(std::string &out, std::string_view value);
+
+void append_integer(std::string &out, int64_t value);
+void append_unsigned(std::string &out, uint64_t value);
+
+/**
+ * @brief Append the shortest text that reads back as the same double, always
+ * with a fraction or exponent so it reads back as a floating point number.
+ * JSON has no representation for NaN or infinity; those are written as null.
+ */
+void append_floating(std::string &out, double value);
+
+/**
+ * @brief Scanning helpers.  Each starts at 'p', advances it past what was
+ * scanned, and returns false (leaving 'p' unspecified) on malformed input.
+ */
+const char* skip_whitespace(const char *p, const char *end);
+
+/**
+ * @brief Scan a string (starting at its opening quote), unescaping it into
+ * 'out' if one is given.
+ */
+bool scan_string(const char *&p, const char *end, std::string *out);
+
+/**
+ * @brief As scan_string, for object keys: 'key' refers to the text itself
+ * when nothing in it is escaped, otherwise to 'scratch', which holds the
+ * unescaped copy.  Either way it is valid until the next scan.
+ */
+bool scan_key(const char *&p, const char *end, std::string &scratch, std::string_view &key);
+
+/**
+ * @brief Scan a number into an integer scalar if it has no fraction or
+ * exponent and fits in 64 bits (unsigned values stored by bit pattern, as
+ * elsewhere), otherwise into a floating point scalar.
+ */
+bool scan_number(const char *&p, const char *end, ::lldc::reflection::type::Scalar *out);
+
+/**
+ * @brief Skip one complete value of any kind (nesting limited to MAX_DEPTH).
+ */
+bool skip_value(const char *&p, const char *end, unsigned depth = 0);
+
+/**
+ * @brief True if the text is exactly one JSON value, give or take whitespace.
+ */
+bool is_valid(std::string_view text);
+
+// Deepest nesting of arrays and objects accepted when scanning.
+static const unsigned MAX_DEPTH = 512;
+
+}; // lldc::reflection::json
@@ -8,18 +8,22 @@
 #pragma once
 
 #include <rttr/registration>
+#include <lldc-reflection/metadata/metadata.h>
 
 namespace lldc::reflection::metadata {
 extern const char* const OPTIONAL;
 extern const char* const OPTIONAL_DEFAULT;
 extern const char* const NO_SERIALIZE;
 extern const char* const BLOB;
+extern const char* const MEMBER_ACCESS;
 
 bool is_optional(const ::rttr::property &property, bool *has_default);
 bool is_optional(const ::rttr::property& property, const ::rttr::variant& reference, bool *matched_reference);
 
 bool is_no_serialize(const ::rttr::property &propety);
 
+std::shared_ptr<const MemberAccess> get_member_access(const ::rttr::property &property);
+
 template <typename T>
 bool is_blob(const T &t) {
   auto md = t.get_metadata(metadata::BLOB);
@@ -0,0 +1,183 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for the per-type conversion plans.  Rather than asking
+ * RTTR for the property list and decoding each property's metadata on
+ * every conversion, the converters ask for the plan of the derived type
+ * and walk its flat list of pre-decoded property descriptors.
+ *
+ * Plans are built on first use and cached for the life of the process,
+ * so all registrations for a type must be complete before that type is
+ * first converted.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <memory>
+
+#include <rttr/registration>
+#include <lldc-reflection/metadata/metadata.h>
+
+#include "private/type/type.h"
+
+namespace lldc::reflection::plan {
+
+/**
+ * @brief How the property's value will be written, classified from its
+ * (unwrapped) registered type.
+ */
+enum class ValueKind {
+  fundamental,
+  any,
+  sequential,
+  associative,
+  blob,    // a Blob (lldc-reflection/blob.h), held by value
+  buffer,  // a std::shared_ptr<const std::string> registered as a blob
+  object
+};
+
+struct PropertyPlan {
+  explicit PropertyPlan(const ::rttr::property &prop);
+
+  /**
+   * @brief Read the property from the object.  Containers and nested objects
+   * are returned as a std::reference_wrapper to the member when the
+   * registration provides direct access to it, rather than as a copy.
+   */
+  ::rttr::variant get_value(const ::rttr::instance &obj) const;
+
+  /**
+   * @brief Read the property as a decode target.  Like get_value, but also
+   * used for members with a registered default, since nothing is compared.
+   * Use refers_to_member() on the result to know if it must be written back.
+   */
+  ::rttr::variant get_target(const ::rttr::instance &obj) const;
+
+  /**
+   * @brief Read a scalar member straight from the object, enumerations as
+   * their names.  Returns false if the member has no typed access, in which
+   * case use get_value.
+   */
+  bool load_scalar(const ::rttr::instance &obj, ::lldc::reflection::type::Scalar &out) const;
+
+  /**
+   * @brief Write the scalar straight into the member.  Returns false if the
+   * member has no typed access or the scalar does not directly represent a
+   * value of the member's type, in which case decode it through a variant.
+   * A string is moved out of the scalar.
+   */
+  bool store_scalar(const ::rttr::instance &obj, ::lldc::reflection::type::Scalar &in) const;
+
+  ::rttr::property property;
+
+  // The registered type, and the wrapped type if 'wrapped' is true.
+  ::rttr::type type;
+  bool wrapped;
+  ValueKind kind;
+
+  bool optional;
+  bool has_default;
+  ::rttr::variant default_value;
+  bool no_serialize;
+  bool blob;
+
+  // Set if the member was registered with in_place_property and
+  // is a by-value container or object, so it can be read (and decoded) in
+  // place, or is a scalar with a codec (below).
+  std::shared_ptr<const ::lldc::reflection::metadata::MemberAccess> access;
+
+  // Typed access to scalar members: the codec for the member's type (or an
+  // enumeration's underlying type), the enumerators as loaded by that codec
+  // with their names, and the default value as loaded, for comparison.
+  const ::lldc::reflection::type::ScalarCodec *scalar_codec;
+  std::vector<std::pair<int64_t, std::string>> enumerators;
+  ::lldc::reflection::type::Scalar default_scalar;
+
+  // Member name as it is written into the converted message, and as it is
+  // written into JSON text: escaped, quoted and followed by the ':'.
+  std::string key;
+  std::string json_key;
+
+  // The key's place among the type's keys in std::map order (ties in
+  // property order), so writers building sorted maps can add an object's
+  // members in that order rather than searching for each one's place.
+  uint32_t key_rank;
+
+private:
+  // Replace a loaded enumeration value by its name, if it has one.
+  void name_enumerator(::lldc::reflection::type::Scalar &value) const;
+};
+
+struct TypePlan {
+  std::vector<PropertyPlan> properties;
+
+  /**
+   * @brief Find the property whose key matches the given member name using
+   * the type's perfect hash index.  Returns nullptr for unknown names.
+   */
+  const PropertyPlan* find(std::string_view key) const;
+
+  // Hash-and-displace index over the property keys: the first hash selects
+  // a displacement, the displaced hash selects a slot in 'slots', which
+  // holds the index into 'properties' (or -1).
+  std::vector<uint32_t> displacements;
+  std::vector<int32_t> slots;
+};
+
+/**
+ * @brief Tracks which of a plan's properties were found while walking the
+ * members of an incoming object once, so unknown members and missing
+ * required members are both known at the end of that single pass.
+ */
+class MemberTally {
+public:
+  explicit MemberTally(const TypePlan &plan);
+  MemberTally(const MemberTally&) = delete;
+  MemberTally& operator=(const MemberTally&) = delete;
+
+  /**
+   * @brief Look up the member name, marking the property as seen.
+   * @return the property to decode, or nullptr if the member is unknown and
+   * should be skipped.
+   */
+  const PropertyPlan* visit(std::string_view key);
+
+  // Number of members visited that did not map to any property.
+  size_t unknown() const { return _unknown; }
+
+  // The first required property that was never visited, if any.
+  const PropertyPlan* first_missing() const;
+
+private:
+  const TypePlan &_plan;
+  size_t _unknown;
+  std::array<uint64_t, 4> _inline_bits;
+  std::vector<uint64_t> _heap_bits;
+  uint64_t *_bits;
+};
+
+/**
+ * @brief True if the variant (from get_value or get_target) refers to the
+ * member's own storage rather than holding a copy of it, so anything decoded
+ * into it is already in the object and need not be set back.
+ */
+inline bool
+refers_to_member (const ::rttr::variant &var)
+{
+  const auto t = var.get_type();
+  return t.is_wrapper() && !t.get_wrapped_type().is_pointer();
+}
+
+/**
+ * @brief Fetch (building if necessary) the plan for the given type.  The
+ * returned reference remains valid for the life of the process.
+ */
+const TypePlan& get_type_plan(const ::rttr::type &t);
+
+}; // lldc::reflection::plan
@@ -0,0 +1,91 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for the USDT (sys/sdt.h) static tracepoints, built in with
+ * the 'usdt' meson option.  Each probe is a nop until a tracer (perf,
+ * bpftrace, ...) attaches to it, and its arguments are only worked out while
+ * one is attached.  Without the option, everything here compiles away.
+ *
+ * Probes (provider 'lldc_reflection'):
+ *
+ *   convert_start (const char *converter, const char *type)
+ *   convert_done  (const char *converter, const char *type, size_t bytes, int ok)
+ *     Around each top-level conversion; 'bytes' as in lldc-reflection/stats.h.
+ *
+ *   object_start  (const char *type)
+ *   object_done   (const char *type, size_t bytes, int result)
+ *     Around each object the engine writes or reads, nested ones included;
+ *     'bytes' are the string and blob bytes within it and 'result' is 1 if
+ *     it was written (read), 0 if nothing was written, -1 if it failed.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <rttr/registration>
+
+#if LLDC_REFLECTION_USDT
+  // Each probe has a semaphore, counting the tracers attached to it.
+  #define _SDT_HAS_SEMAPHORES 1
+  #include <sys/sdt.h>
+
+  extern "C" {
+    extern volatile unsigned short lldc_reflection_convert_start_semaphore;
+    extern volatile unsigned short lldc_reflection_convert_done_semaphore;
+    extern volatile unsigned short lldc_reflection_object_start_semaphore;
+    extern volatile unsigned short lldc_reflection_object_done_semaphore;
+  }
+
+  #define LLDC_REFLECTION_PROBE_ENABLED(name) \
+    __builtin_expect(lldc_reflection_##name##_semaphore != 0, 0)
+  #define LLDC_REFLECTION_PROBE(name, ...) \
+    STAP_PROBEV(lldc_reflection, name, __VA_ARGS__)
+#else
+  #define LLDC_REFLECTION_PROBE_ENABLED(name) false
+  #define LLDC_REFLECTION_PROBE(name, ...) do {} while (0)
+#endif
+
+namespace lldc::reflection::probes {
+
+/**
+ * @brief Fires object_start for the (unwrapped) object, and object_done
+ * when it goes out of scope.  'bytes' is the writer's (reader's) running
+ * count.
+ */
+class ObjectProbe {
+public:
+#if LLDC_REFLECTION_USDT
+  ObjectProbe(const ::rttr::instance &obj, const size_t &bytes) {
+    if (LLDC_REFLECTION_PROBE_ENABLED(object_start) || LLDC_REFLECTION_PROBE_ENABLED(object_done)) {
+      _type = obj.get_derived_type().get_name().data();
+      _bytes = &bytes;
+      _start = bytes;
+      LLDC_REFLECTION_PROBE(object_start, _type);
+    }
+  }
+
+  ~ObjectProbe() {
+    if (_type)
+      LLDC_REFLECTION_PROBE(object_done, _type, *_bytes - _start, _result);
+  }
+
+  void result(bool written) {
+    _result = written ? 1 : 0;
+  }
+
+private:
+  const char *_type = nullptr;
+  const size_t *_bytes = nullptr;
+  size_t _start = 0;
+  int _result = -1;
+#else
+  ObjectProbe(const ::rttr::instance &, const size_t &) {}
+  void result(bool) {}
+#endif
+
+  ObjectProbe(const ObjectProbe&) = delete;
+  ObjectProbe& operator=(const ObjectProbe&) = delete;
+};
+
+}; // lldc::reflection::probes
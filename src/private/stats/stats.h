@@ -0,0 +1,84 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for recording conversion statistics.  A converter opens a
+ * Sample on entry; when statistics are off, or this conversion is not one
+ * of the sampled ones, that is all it costs.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <rttr/registration>
+#include <lldc-reflection/stats.h>
+
+#include "private/probes/probes.h"
+
+namespace lldc::reflection::stats {
+
+extern std::atomic<bool> enabled;
+extern std::atomic<uint32_t> sample_interval;
+
+/**
+ * @brief Add one (sampled) conversion to the calling thread's shard.
+ */
+void record (Converter converter, const ::rttr::type &t, uint32_t weight, bool ok, size_t bytes, uint64_t ns);
+
+/**
+ * @brief Times a conversion of the object, if it is sampled, and records it
+ * when the Sample goes out of scope: as a failure unless succeeded() was
+ * called (so a conversion that throws counts as failed).  It also fires the
+ * convert_start and convert_done probes (see private/probes/probes.h).
+ */
+class Sample {
+public:
+  Sample(Converter converter, const ::rttr::instance &object) :
+    _converter(converter),
+    _object(object)
+  {
+#if LLDC_REFLECTION_USDT
+    if (LLDC_REFLECTION_PROBE_ENABLED(convert_start))
+      probe_start();
+#endif
+    if (!enabled.load(std::memory_order_relaxed))
+      return;
+
+    thread_local uint32_t countdown = 0;
+    if (countdown > 1) {
+      countdown--;
+      return;
+    }
+    countdown = sample_interval.load(std::memory_order_relaxed);
+    _weight = countdown;
+    _start = std::chrono::steady_clock::now();
+  }
+
+  ~Sample();
+
+  Sample(const Sample&) = delete;
+  Sample& operator=(const Sample&) = delete;
+
+  void succeeded(size_t bytes) {
+    _ok = true;
+    _bytes = bytes;
+  }
+
+private:
+#if LLDC_REFLECTION_USDT
+  void probe_start() const;
+  void probe_done() const;
+#endif
+
+  Converter _converter;
+  const ::rttr::instance &_object;
+  uint32_t _weight = 0;
+  bool _ok = false;
+  size_t _bytes = 0;
+  std::chrono::steady_clock::time_point _start;
+};
+
+}; // lldc::reflection::stats
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Private header for recording trace spans (see lldc-reflection/trace.h).
+ * The engine opens a Scope around each object and member; unless the
+ * context is tracing, that is a null check.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rttr/registration>
+
+namespace lldc::reflection::plan {
+  struct PropertyPlan;
+}; // lldc::reflection::plan
+
+namespace lldc::reflection::trace {
+
+struct Span {
+  std::string name;
+  const char *category;
+  std::string type;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::duration duration {};
+  size_t bytes = 0;
+};
+
+/**
+ * @brief A tracing context's spans, in the order they were opened (so each
+ * span's children follow it).
+ */
+struct Recorder {
+  std::vector<Span> spans;
+  uint32_t id;  // the trace's "thread", one per recorder
+};
+
+/**
+ * @brief Records a span from construction to destruction into the recorder,
+ * if there is one.  'bytes' is the writer's (reader's) running count.
+ */
+class Scope {
+public:
+  Scope(Recorder *recorder, const ::rttr::instance &obj, const size_t &bytes) :
+    _recorder(recorder),
+    _bytes(bytes)
+  {
+    if (recorder)
+      open_object(obj);
+  }
+
+  Scope(Recorder *recorder, const ::lldc::reflection::plan::PropertyPlan &desc, const size_t &bytes) :
+    _recorder(recorder),
+    _bytes(bytes)
+  {
+    if (recorder)
+      open_member(desc);
+  }
+
+  ~Scope() {
+    if (_recorder)
+      close();
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  void open_object(const ::rttr::instance &obj);
+  void open_member(const ::lldc::reflection::plan::PropertyPlan &desc);
+  void close();
+
+  Recorder *_recorder;
+  const size_t &_bytes;
+  size_t _index = 0;
+  size_t _start_bytes = 0;
+};
+
+}; // lldc::reflection::trace
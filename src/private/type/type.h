@@ -8,6 +8,8 @@
 
 #include <rttr/registration>
 #include <any>
+#include <cstdint>
+#include <string>
 
 namespace lldc::reflection::type {
 
@@ -19,6 +21,100 @@ inline bool is_any(const ::rttr::type& t) {
   return (t == ::rttr::type::get<std::any>());
 }
 
+/**
+ * @brief True for a class held by value that is neither a fundamental nor a
+ * container, i.e., one decoded member-by-member from an object.
+ */
+inline bool is_value_object(const ::rttr::type &t) {
+  return (t.is_class() && !t.is_wrapper() && !is_fundamental(t) && !is_any(t)
+    && !t.is_sequential_container() && !t.is_associative_container());
+}
+
+/**
+ * @brief Strip any wrappers (std::shared_ptr, std::reference_wrapper, or both
+ * nested) from the instance so it refers to the wrapped object itself.
+ */
+inline ::rttr::instance unwrap_instance(const ::rttr::instance &obj) {
+  if (obj.get_type().get_raw_type().is_wrapper())
+    return unwrap_instance(obj.get_wrapped_instance());
+  return obj;
+}
+
 ::rttr::variant extract_any_value(const ::rttr::variant &in);
 
-}; // lldc::reflection::metadata
+/**
+ * @brief The converter-neutral representation of a fundamental value.
+ * Unsigned integers are carried in 'integer' by bit pattern, as they are
+ * stored by the intermediate types, and cast back on the way in; 'is_unsigned'
+ * marks those whose bits are a uint64_t, for the writers that can say so.
+ */
+enum class ScalarKind {
+  none,
+  boolean,
+  integer,
+  floating,
+  character,
+  string
+};
+
+struct Scalar {
+  ScalarKind kind = ScalarKind::none;
+  bool boolean = false;
+  int64_t integer = 0;
+  bool is_unsigned = false;  // integer: read it as a uint64_t
+  double floating = 0.0;
+  std::string string;
+
+  bool operator==(const Scalar &other) const {
+    if (kind != other.kind)
+      return false;
+    switch (kind) {
+      case ScalarKind::boolean:   return boolean == other.boolean;
+      case ScalarKind::integer:   return integer == other.integer && is_unsigned == other.is_unsigned;
+      case ScalarKind::floating:  return floating == other.floating;
+      case ScalarKind::character:
+      case ScalarKind::string:    return string == other.string;
+      default:                    return true;
+    }
+  }
+};
+
+/**
+ * @brief Encode and decode functions for one fundamental type, shared by
+ * all converters so each scalar costs one table lookup and one call.
+ *   encode: read the variant (which must hold exactly this type)
+ *   decode: produce a variant of this type, or an invalid variant if the
+ *           scalar cannot be represented by it.
+ *   load:   as encode, reading the value at the address instead
+ *   store:  write the scalar to the address if it represents this type
+ *           directly; returns false (address untouched) otherwise, leaving
+ *           any other conversion to the variant path.
+ * decode and store move a string out of the scalar, which is only scratch
+ * space, rather than copying it.
+ */
+struct ScalarCodec {
+  void (*encode)(const ::rttr::variant &var, Scalar &out);
+  ::rttr::variant (*decode)(Scalar &in);
+  void (*load)(const void *src, Scalar &out);
+  bool (*store)(Scalar &in, void *dst);
+};
+
+/**
+ * @brief Find the codec for the type, or nullptr if the type is not one of
+ * the arithmetic types or std::string (e.g., enumerations).
+ */
+const ScalarCodec* find_scalar_codec(const ::rttr::type &t);
+
+/**
+ * @brief Box the scalar as its natural type (bool, int64_t, double, std::string),
+ * wrapped in a std::any if the target type is one, for types without a codec.
+ */
+::rttr::variant scalar_to_variant(const Scalar &in, const ::rttr::type &t);
+
+/**
+ * @brief Decode the scalar with the target type's codec, or box it with
+ * scalar_to_variant for the caller to convert if the type has none.
+ */
+::rttr::variant decode_scalar_to(Scalar &in, const ::rttr::type &t);
+
+}; // lldc::reflection::type
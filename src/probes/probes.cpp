@@ -0,0 +1,23 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include "private/probes/probes.h"
+
+#if LLDC_REFLECTION_USDT
+
+// The probes' semaphores, which tracers find (and bump) in the .probes
+// section when they attach.
+#define LLDC_REFLECTION_SEMAPHORE(name) \
+  volatile unsigned short lldc_reflection_##name##_semaphore \
+    __attribute__((unused, section(".probes"))) = 0;
+
+extern "C" {
+  LLDC_REFLECTION_SEMAPHORE(convert_start)
+  LLDC_REFLECTION_SEMAPHORE(convert_done)
+  LLDC_REFLECTION_SEMAPHORE(object_start)
+  LLDC_REFLECTION_SEMAPHORE(object_done)
+}
+
+#endif
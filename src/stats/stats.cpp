@@ -0,0 +1,346 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+#include "private/stats/stats.h"
+#include "private/type/type.h"
+
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::stats {
+
+std::atomic<bool> enabled = false;
+std::atomic<uint32_t> sample_interval = 1;
+
+/**
+ * @brief One type and converter's figures in one shard.  Only the shard's
+ * thread adds to them, but reset() and snapshot() may run on any thread,
+ * hence the (relaxed) atomics.
+ */
+struct Counters {
+  Counters(const ::rttr::type &t, Converter converter) : type(t), converter(converter) {}
+
+  const ::rttr::type type;
+  const Converter converter;
+
+  std::atomic<uint64_t> calls = 0;
+  std::atomic<uint64_t> failures = 0;
+  std::atomic<uint64_t> bytes = 0;
+  std::atomic<uint64_t> latency_sum_ns = 0;
+  std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latency {};
+};
+
+/**
+ * @brief One thread's statistics: an open-addressed table from type and
+ * converter to its Counters.  The owning thread fills in a slot's counters
+ * before publishing its key, so readers only see complete entries.  When
+ * the thread exits, the shard (with what it recorded) is handed to the
+ * next thread that needs one.
+ */
+class Shard {
+public:
+  ~Shard() {
+    for (auto &slot : _slots)
+      delete slot.counters.load(std::memory_order_relaxed);
+  }
+
+  // Owning thread only; NULL if the table is full.
+  Counters* find(const ::rttr::type &t, Converter converter) {
+    const uint64_t key = ((static_cast<uint64_t>(t.get_id()) << 8) | static_cast<uint64_t>(converter)) + 1;
+    size_t i = (key * 0x9E3779B97F4A7C15ull) >> (64 - SLOT_BITS);
+
+    for (size_t probe = 0; probe < SLOTS; probe++, i = (i + 1) & (SLOTS - 1)) {
+      auto &slot = _slots[i];
+      const uint64_t found = slot.key.load(std::memory_order_relaxed);
+      if (found == key)
+        return slot.counters.load(std::memory_order_relaxed);
+      if (found == 0) {
+        auto counters = new Counters(t, converter);
+        slot.counters.store(counters, std::memory_order_relaxed);
+        slot.key.store(key, std::memory_order_release);
+        return counters;
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename F>
+  void for_each(F &&f) {
+    for (auto &slot : _slots) {
+      if (slot.key.load(std::memory_order_acquire))
+        f(*slot.counters.load(std::memory_order_relaxed));
+    }
+  }
+
+  std::atomic<bool> in_use = false;
+
+private:
+  static const size_t SLOT_BITS = 10;
+  static const size_t SLOTS = size_t(1) << SLOT_BITS;
+
+  struct Slot {
+    std::atomic<uint64_t> key = 0;
+    std::atomic<Counters*> counters = nullptr;
+  };
+
+  Slot _slots[SLOTS];
+};
+
+/**
+ * @brief Every shard ever created.  Its lock is only taken when a thread
+ * records for the first time, exits, or the statistics are read.
+ */
+class Shards {
+public:
+  Shard* acquire() {
+    std::lock_guard<std::mutex> guard(_lock);
+    for (auto &shard : _shards) {
+      if (!shard->in_use.load(std::memory_order_relaxed)) {
+        shard->in_use.store(true, std::memory_order_relaxed);
+        return shard.get();
+      }
+    }
+    _shards.push_back(std::make_unique<Shard>());
+    _shards.back()->in_use.store(true, std::memory_order_relaxed);
+    return _shards.back().get();
+  }
+
+  void release(Shard *shard) {
+    std::lock_guard<std::mutex> guard(_lock);
+    shard->in_use.store(false, std::memory_order_relaxed);
+  }
+
+  template <typename F>
+  void for_each(F &&f) {
+    std::lock_guard<std::mutex> guard(_lock);
+    for (auto &shard : _shards)
+      shard->for_each(f);
+  }
+
+private:
+  std::mutex _lock;
+  std::vector<std::unique_ptr<Shard>> _shards;
+};
+
+// Never destroyed: threads may still exit (and release their shards) while
+// static objects are being destroyed.
+static Shards &shards = *new Shards();
+
+static Shard&
+this_thread_shard ()
+{
+  struct Handle {
+    Shard *shard = shards.acquire();
+    ~Handle() { shards.release(shard); }
+  };
+  thread_local Handle handle;
+  return *handle.shard;
+}
+
+static size_t
+latency_bucket (uint64_t ns)
+{
+  const size_t bucket = std::bit_width(ns / LATENCY_FIRST_BOUND_NS);
+  return std::min(bucket, LATENCY_BUCKETS - 1);
+}
+
+void
+record (Converter converter, const ::rttr::type &t, uint32_t weight, bool ok, size_t bytes, uint64_t ns)
+{
+  Counters *counters = this_thread_shard().find(t, converter);
+  if (!counters)
+    return;
+
+  counters->calls.fetch_add(weight, std::memory_order_relaxed);
+  if (!ok)
+    counters->failures.fetch_add(weight, std::memory_order_relaxed);
+  counters->bytes.fetch_add(static_cast<uint64_t>(bytes) * weight, std::memory_order_relaxed);
+  counters->latency_sum_ns.fetch_add(ns * weight, std::memory_order_relaxed);
+  counters->latency[latency_bucket(ns)].fetch_add(weight, std::memory_order_relaxed);
+}
+
+#if LLDC_REFLECTION_USDT
+// The object's type name, or "" if there is no object.
+static const char*
+type_name (const ::rttr::instance &object)
+{
+  if (!object.is_valid())
+    return "";
+  return TYPE::unwrap_instance(object).get_derived_type().get_name().data();
+}
+
+void
+Sample::probe_start () const
+{
+  LLDC_REFLECTION_PROBE(convert_start, converter_name(_converter), type_name(_object));
+}
+
+void
+Sample::probe_done () const
+{
+  LLDC_REFLECTION_PROBE(convert_done, converter_name(_converter), type_name(_object), _bytes, _ok ? 1 : 0);
+}
+#endif
+
+Sample::~Sample ()
+{
+#if LLDC_REFLECTION_USDT
+  if (LLDC_REFLECTION_PROBE_ENABLED(convert_done))
+    probe_done();
+#endif
+  if (!_weight || !_object.is_valid())
+    return;
+
+  const auto elapsed = std::chrono::steady_clock::now() - _start;
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  record(_converter, TYPE::unwrap_instance(_object).get_derived_type(), _weight, _ok, _bytes, static_cast<uint64_t>(ns));
+}
+
+const char*
+converter_name (Converter converter)
+{
+  switch (converter) {
+    case Converter::to_json_glib:   return "to_json_glib";
+    case Converter::from_json_glib: return "from_json_glib";
+    case Converter::to_socket_io:   return "to_socket_io";
+    case Converter::from_socket_io: return "from_socket_io";
+    case Converter::to_json:        return "to_json";
+    case Converter::from_json:      return "from_json";
+  }
+  return "unknown";
+}
+
+void
+set_enabled (bool value)
+{
+  enabled.store(value, std::memory_order_relaxed);
+}
+
+bool
+is_enabled ()
+{
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void
+set_sample_interval (uint32_t interval)
+{
+  sample_interval.store(std::max<uint32_t>(interval, 1), std::memory_order_relaxed);
+}
+
+uint32_t
+get_sample_interval ()
+{
+  return sample_interval.load(std::memory_order_relaxed);
+}
+
+std::vector<Entry>
+snapshot ()
+{
+  // Add up the shards by type and converter.
+  std::map<std::pair<::rttr::type::type_id, Converter>, Entry> totals;
+  shards.for_each([&](const Counters &counters) {
+    auto &entry = totals[{counters.type.get_id(), counters.converter}];
+    if (entry.type.empty()) {
+      entry.type = counters.type.get_name().to_string();
+      entry.converter = counters.converter;
+    }
+    entry.calls += counters.calls.load(std::memory_order_relaxed);
+    entry.failures += counters.failures.load(std::memory_order_relaxed);
+    entry.bytes += counters.bytes.load(std::memory_order_relaxed);
+    entry.latency_sum_ns += counters.latency_sum_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+      entry.latency[i] += counters.latency[i].load(std::memory_order_relaxed);
+  });
+
+  std::vector<Entry> out;
+  out.reserve(totals.size());
+  for (auto &total : totals) {
+    if (total.second.calls)
+      out.push_back(std::move(total.second));
+  }
+  std::sort(out.begin(), out.end(), [](const Entry &a, const Entry &b) {
+    return std::tie(a.type, a.converter) < std::tie(b.type, b.converter);
+  });
+  return out;
+}
+
+// Label values escape backslashes, quotes and line feeds.
+static std::string
+labels (const Entry &entry)
+{
+  std::string type;
+  for (const char c : entry.type) {
+    switch (c) {
+      case '\\': type += "\\\\"; break;
+      case '"':  type += "\\\""; break;
+      case '\n': type += "\\n"; break;
+      default:   type += c; break;
+    }
+  }
+  return "type=\"" + type + "\",converter=\"" + converter_name(entry.converter) + "\"";
+}
+
+std::string
+to_prometheus ()
+{
+  const auto entries = snapshot();
+  std::ostringstream out;
+  out.precision(12);
+
+  const auto counter = [&](const char *name, const char *help, uint64_t Entry::*field) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " counter\n";
+    for (const auto &entry : entries)
+      out << name << "{" << labels(entry) << "} " << entry.*field << "\n";
+  };
+  counter("lldc_reflection_conversions_total", "Conversions, by message type and converter.", &Entry::calls);
+  counter("lldc_reflection_conversion_failures_total", "Conversions that failed.", &Entry::failures);
+  counter("lldc_reflection_conversion_bytes_total", "Bytes produced or consumed by conversions.", &Entry::bytes);
+
+  const char *name = "lldc_reflection_conversion_seconds";
+  out << "# HELP " << name << " How long conversions took.\n";
+  out << "# TYPE " << name << " histogram\n";
+  for (const auto &entry : entries) {
+    const auto entry_labels = labels(entry);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+      cumulative += entry.latency[i];
+      out << name << "_bucket{" << entry_labels << ",le=\"";
+      if (i + 1 < LATENCY_BUCKETS)
+        out << static_cast<double>(LATENCY_FIRST_BOUND_NS << i) / 1e9;
+      else
+        out << "+Inf";
+      out << "\"} " << cumulative << "\n";
+    }
+    out << name << "_sum{" << entry_labels << "} " << static_cast<double>(entry.latency_sum_ns) / 1e9 << "\n";
+    out << name << "_count{" << entry_labels << "} " << entry.calls << "\n";
+  }
+
+  return out.str();
+}
+
+void
+reset ()
+{
+  shards.for_each([](Counters &counters) {
+    counters.calls.store(0, std::memory_order_relaxed);
+    counters.failures.store(0, std::memory_order_relaxed);
+    counters.bytes.store(0, std::memory_order_relaxed);
+    counters.latency_sum_ns.store(0, std::memory_order_relaxed);
+    for (auto &bucket : counters.latency)
+      bucket.store(0, std::memory_order_relaxed);
+  });
+}
+
+}; // lldc::reflection::stats
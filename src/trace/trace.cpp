@@ -0,0 +1,110 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+
+#include <atomic>
+#include <memory>
+
+#include <lldc-reflection/trace.h>
+
+#include "private/context/context.h"
+#include "private/json/json.h"
+#include "private/plan/plan.h"
+#include "private/trace/trace.h"
+#include "private/type/type.h"
+
+namespace JSON = lldc::reflection::json;
+namespace PLAN = lldc::reflection::plan;
+namespace TYPE = lldc::reflection::type;
+
+namespace lldc::reflection::trace {
+
+static std::atomic<uint32_t> next_id = 1;
+
+void
+Scope::open_object (const ::rttr::instance &obj)
+{
+  const auto t = TYPE::unwrap_instance(obj).get_derived_type();
+  _index = _recorder->spans.size();
+  _start_bytes = _bytes;
+  _recorder->spans.push_back(Span{
+    t.get_name().to_string(), "object", t.get_name().to_string(), std::chrono::steady_clock::now()});
+}
+
+void
+Scope::open_member (const PLAN::PropertyPlan &desc)
+{
+  _index = _recorder->spans.size();
+  _start_bytes = _bytes;
+  _recorder->spans.push_back(Span{
+    desc.key, "member", desc.type.get_name().to_string(), std::chrono::steady_clock::now()});
+}
+
+void
+Scope::close ()
+{
+  auto &span = _recorder->spans[_index];
+  span.duration = std::chrono::steady_clock::now() - span.start;
+  span.bytes = _bytes - _start_bytes;
+}
+
+// Microseconds, as the trace format wants them, to the nanosecond.
+static void
+append_microseconds (std::string &out, std::chrono::steady_clock::duration d)
+{
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  JSON::append_integer(out, ns / 1000);
+  const auto fraction = std::to_string(1000 + ns % 1000);
+  out += '.';
+  out.append(fraction, 1, 3);
+}
+
+static std::string
+to_chrome_trace (const Recorder &recorder)
+{
+  std::string out = "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto &span : recorder.spans) {
+    if (!first)
+      out += ',';
+    first = false;
+
+    out += "{\"name\":";
+    JSON::append_string(out, span.name);
+    out += ",\"cat\":\"";
+    out += span.category;
+    out += "\",\"ph\":\"X\",\"ts\":";
+    append_microseconds(out, span.start.time_since_epoch());
+    out += ",\"dur\":";
+    append_microseconds(out, span.duration);
+    out += ",\"pid\":1,\"tid\":";
+    JSON::append_integer(out, recorder.id);
+    out += ",\"args\":{\"type\":";
+    JSON::append_string(out, span.type);
+    out += ",\"bytes\":";
+    JSON::append_integer(out, static_cast<int64_t>(span.bytes));
+    out += "}}";
+  }
+  out += "],\"displayTimeUnit\":\"ns\"}";
+  return out;
+}
+
+void
+start (ConversionContext &context)
+{
+  auto recorder = std::make_unique<Recorder>();
+  recorder->id = next_id.fetch_add(1, std::memory_order_relaxed);
+  context.state().trace = std::move(recorder);
+}
+
+std::string
+stop (ConversionContext &context)
+{
+  auto recorder = std::move(context.state().trace);
+  if (!recorder)
+    return std::string();
+  return to_chrome_trace(*recorder);
+}
+
+}; // lldc::reflection::trace
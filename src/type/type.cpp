@@ -5,6 +5,7 @@
 
 #include <any>
 #include <functional>
+#include <limits>
 #include <type_traits>
 #include <typeindex>
 #include <typeinfo>
@@ -31,7 +32,7 @@ to_any_visitor(F const& f)
   };
 }
 
-static std::unordered_map<std::type_index, std::function<::rttr::variant(std::any const&)>>
+static const std::unordered_map<std::type_index, std::function<::rttr::variant(std::any const&)>>
 any_visitor
 {
     to_any_visitor<void>([] { return 0; }),
@@ -64,4 +65,206 @@ extract_any_value(const ::rttr::variant &in)
   return ::rttr::variant();
 }
 
+::rttr::variant
+scalar_to_variant(const Scalar &in, const ::rttr::type &t)
+{
+  const bool as_any = is_any(t);
+
+  switch (in.kind) {
+    case ScalarKind::boolean:
+      return (as_any) ? ::rttr::variant(std::any(in.boolean)) : ::rttr::variant(in.boolean);
+    case ScalarKind::integer:
+      if (in.is_unsigned) {
+        const auto value = static_cast<uint64_t>(in.integer);
+        return (as_any) ? ::rttr::variant(std::any(value)) : ::rttr::variant(value);
+      }
+      return (as_any) ? ::rttr::variant(std::any(in.integer)) : ::rttr::variant(in.integer);
+    case ScalarKind::floating:
+      return (as_any) ? ::rttr::variant(std::any(in.floating)) : ::rttr::variant(in.floating);
+    case ScalarKind::character:
+      return (as_any) ? ::rttr::variant(std::any(in.string[0])) : ::rttr::variant(in.string[0]);
+    case ScalarKind::string:
+      return (as_any) ? ::rttr::variant(std::any(in.string)) : ::rttr::variant(in.string);
+    default:
+      break;
+  }
+  return ::rttr::variant();
+}
+
+/**
+ * @brief Fall back on RTTR's own conversion from the scalar's natural type,
+ * for the combinations the codecs do not handle directly (e.g., a number
+ * held in a string).
+ */
+static ::rttr::variant
+convert_scalar(const Scalar &in, const ::rttr::type &t)
+{
+  ::rttr::variant out = scalar_to_variant(in, t);
+  if (out.is_valid() && out.convert(t))
+    return out;
+  return ::rttr::variant();
+}
+
+template<class T>
+static void
+load_value(const T &value, Scalar &out)
+{
+  if constexpr (std::is_same_v<T, bool>) {
+    out.kind = ScalarKind::boolean;
+    out.boolean = value;
+  }
+  else if constexpr (std::is_same_v<T, char>) {
+    out.kind = ScalarKind::character;
+    out.string.assign(1, value);
+  }
+  else if constexpr (std::is_same_v<T, std::string>) {
+    out.kind = ScalarKind::string;
+    out.string = value;
+  }
+  else if constexpr (std::is_floating_point_v<T>) {
+    out.kind = ScalarKind::floating;
+    out.floating = static_cast<double>(value);
+  }
+  else {
+    out.kind = ScalarKind::integer;
+    out.integer = static_cast<int64_t>(value);
+    out.is_unsigned = std::is_unsigned_v<T>;
+  }
+}
+
+/**
+ * @brief Narrow the scalar to T if it represents one directly.  Returns false
+ * for the combinations left to convert_scalar.
+ */
+template<class T>
+static bool
+store_value(Scalar &in, T &out)
+{
+  if constexpr (std::is_same_v<T, bool>) {
+    if (in.kind == ScalarKind::boolean) {
+      out = in.boolean;
+      return true;
+    }
+  }
+  else if constexpr (std::is_same_v<T, char>) {
+    if ((in.kind == ScalarKind::string || in.kind == ScalarKind::character) && in.string.size() <= 1) {
+      out = (in.string.empty()) ? '\0' : in.string[0];
+      return true;
+    }
+  }
+  else if constexpr (std::is_same_v<T, std::string>) {
+    if (in.kind == ScalarKind::string || in.kind == ScalarKind::character) {
+      out = std::move(in.string);
+      return true;
+    }
+  }
+  else if constexpr (std::is_floating_point_v<T>) {
+    if (in.kind == ScalarKind::floating) {
+      out = static_cast<T>(in.floating);
+      return true;
+    }
+    if (in.kind == ScalarKind::integer) {
+      out = (in.is_unsigned) ? static_cast<T>(static_cast<uint64_t>(in.integer)) : static_cast<T>(in.integer);
+      return true;
+    }
+  }
+  else if constexpr (std::is_unsigned_v<T>) {
+    // Stored by bit pattern; cast back.
+    if (in.kind == ScalarKind::integer) {
+      out = static_cast<T>(in.integer);
+      return true;
+    }
+  }
+  else {
+    if (in.kind == ScalarKind::integer && !(in.is_unsigned && in.integer < 0) &&
+        in.integer >= std::numeric_limits<T>::min() &&
+        in.integer <= std::numeric_limits<T>::max()) {
+      out = static_cast<T>(in.integer);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+template<class T>
+static void
+encode_scalar(const ::rttr::variant &var, Scalar &out)
+{
+  load_value<T>(var.get_value<T>(), out);
+}
+
+template<class T>
+static ::rttr::variant
+decode_scalar(Scalar &in)
+{
+  T value {};
+  if (store_value<T>(in, value))
+    return value;
+  return convert_scalar(in, ::rttr::type::get<T>());
+}
+
+template<class T>
+static void
+load_scalar(const void *src, Scalar &out)
+{
+  load_value<T>(*static_cast<const T*>(src), out);
+}
+
+template<class T>
+static bool
+store_scalar(Scalar &in, void *dst)
+{
+  return store_value<T>(in, *static_cast<T*>(dst));
+}
+
+template<class T>
+static std::pair<const ::rttr::type::type_id, ScalarCodec>
+to_scalar_codec()
+{
+  return {
+    ::rttr::type::get<T>().get_id(),
+    ScalarCodec { &encode_scalar<T>, &decode_scalar<T>, &load_scalar<T>, &store_scalar<T> }
+  };
+}
+
+static const std::unordered_map<::rttr::type::type_id, ScalarCodec>
+scalar_codecs
+{
+    to_scalar_codec<bool>(),
+    to_scalar_codec<char>(),
+    to_scalar_codec<int>(),
+    to_scalar_codec<int8_t>(),
+    to_scalar_codec<int16_t>(),
+    to_scalar_codec<int32_t>(),
+    to_scalar_codec<int64_t>(),
+    to_scalar_codec<long long>(),
+    to_scalar_codec<uint8_t>(),
+    to_scalar_codec<uint16_t>(),
+    to_scalar_codec<uint32_t>(),
+    to_scalar_codec<uint64_t>(),
+    to_scalar_codec<unsigned long long>(),
+    to_scalar_codec<float>(),
+    to_scalar_codec<double>(),
+    to_scalar_codec<std::string>(),
+};
+
+const ScalarCodec*
+find_scalar_codec(const ::rttr::type &t)
+{
+  if (const auto it = scalar_codecs.find(t.get_id()); it != scalar_codecs.cend())
+    return &it->second;
+  return nullptr;
+}
+
+::rttr::variant
+decode_scalar_to(Scalar &in, const ::rttr::type &t)
+{
+  // Fundamental targets decode straight to their type; anything else (std::any,
+  // enumerations) gets the natural type for the caller to convert.
+  if (const auto codec = find_scalar_codec(t))
+    return codec->decode(in);
+  return scalar_to_variant(in, t);
+}
+
 };// lldc::reflection::type
\ No newline at end of file
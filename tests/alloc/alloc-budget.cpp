@@ -0,0 +1,140 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Holds each converter to the number of allocations a to and from
+ * conversion of each example message made when its budget was recorded.
+ * The budgets file is the last argument, and a message with no budget fails.
+ * With --record, nothing is checked and the file is rewritten with what the
+ * current code measures instead.  The test never records; the
+ * record-alloc-budget-* run targets do (see meson.build), e.g.:
+ *
+ *   ninja -C builddir record-alloc-budget-json
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <common/common.h>
+#include <common/uut.h>
+
+#include "alloc-count.h"
+
+namespace ALLOC = lldc::testing::alloc;
+
+using namespace lldc::testing;
+
+struct Budget {
+  size_t to = 0;
+  size_t from = 0;
+};
+
+static std::string budgets_path;
+static bool recording = false;
+static std::map<std::string, Budget> budgets;
+static std::map<std::string, Budget> measured;
+
+static void
+load_budgets ()
+{
+  std::ifstream in(budgets_path);
+  std::string line;
+
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream fields(line);
+    std::string name;
+    Budget budget;
+    if (fields >> name >> budget.to >> budget.from)
+      budgets[name] = budget;
+  }
+}
+
+static void
+record_budgets ()
+{
+  // Budgets for messages that were not measured (e.g., filtered out) stay.
+  for (const auto &[name, budget] : measured)
+    budgets[name] = budget;
+
+  std::ofstream out(budgets_path, std::ios::trunc);
+  out << "# Allocations per call, recorded by the record-alloc-budget-* run targets.\n";
+  out << "# type to from\n";
+  for (const auto &[name, budget] : budgets)
+    out << name << " " << budget.to << " " << budget.from << "\n";
+}
+
+template <typename T>
+static void
+check_budget ()
+{
+  const std::string name = ::rttr::type::get<T>().get_name().to_string();
+  T input;
+  fill_example(input);
+
+  // Warm up, so one-time costs (e.g., building the type plans) are excluded.
+  uut_type temp = to_conversion(input);
+  {
+    T output;
+    ASSERT_TRUE(from_conversion(temp, output));
+  }
+  uut_unref(temp);
+
+  const auto to = ALLOC::measure([&] { temp = to_conversion(input); });
+
+  T output;
+  bool ok = false;
+  const auto from = ALLOC::measure([&] { ok = from_conversion(temp, output); });
+  uut_unref(temp);
+  ASSERT_TRUE(ok);
+
+  std::cout << name << ": to " << to.allocations << " allocations (" << to.bytes << " bytes), "
+    << "from " << from.allocations << " allocations (" << from.bytes << " bytes)" << std::endl;
+  measured[name] = Budget{to.allocations, from.allocations};
+
+  if (recording)
+    return;
+
+  const auto budget = budgets.find(name);
+  if (budget == budgets.end())
+    FAIL() << "No allocation budget recorded for " << name << " in " << budgets_path
+      << "; record it with the record-alloc-budget-* run target";
+
+  EXPECT_LE(to.allocations, budget->second.to) << name << " to-conversion is over budget";
+  EXPECT_LE(from.allocations, budget->second.from) << name << " from-conversion is over budget";
+}
+
+TEST(AllocationBudget, FirstMessage) { check_budget<FirstMessage>(); }
+TEST(AllocationBudget, SecondMessage) { check_budget<SecondMessage>(); }
+TEST(AllocationBudget, OptionalMemberMessage) { check_budget<OptionalMemberMessage>(); }
+TEST(AllocationBudget, SimpleMessage) { check_budget<SimpleMessage>(); }
+TEST(AllocationBudget, MessageWithAnys) { check_budget<MessageWithAnys>(); }
+TEST(AllocationBudget, MessageWithVectors) { check_budget<MessageWithVectors>(); }
+TEST(AllocationBudget, MessageWithBlob) { check_budget<MessageWithBlob>(); }
+TEST(AllocationBudget, MaybeEmpty) { check_budget<MaybeEmpty>(); }
+
+int main (int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  recording = (argc == 3 && std::strcmp(argv[1], "--record") == 0);
+  if (argc != 2 && !recording) {
+    std::cerr << "usage: " << argv[0] << " [--record] <budgets file>" << std::endl;
+    return 1;
+  }
+  budgets_path = argv[argc - 1];
+  load_budgets();
+
+  const int result = RUN_ALL_TESTS();
+
+  if (recording)
+    record_budgets();
+
+  return result;
+}
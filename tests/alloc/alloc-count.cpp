@@ -0,0 +1,124 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * With glibc, operator new allocates from glibc's malloc directly, so an
+ * allocation is only counted once whichever way it was made.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "alloc-count.h"
+
+#if defined(__GLIBC__)
+extern "C" {
+  void *__libc_malloc(size_t size);
+  void *__libc_calloc(size_t count, size_t size);
+  void *__libc_realloc(void *ptr, size_t size);
+  void __libc_free(void *ptr);
+}
+#define RAW_MALLOC __libc_malloc
+#define RAW_FREE __libc_free
+#else
+#define RAW_MALLOC std::malloc
+#define RAW_FREE std::free
+#endif
+
+namespace lldc::testing::alloc {
+
+// Constant-initialized, so it's usable from within malloc itself.
+static thread_local Counts counts;
+
+Counts
+current ()
+{
+  return counts;
+}
+
+static inline void
+record (size_t size)
+{
+  counts.allocations++;
+  counts.bytes += size;
+}
+
+static inline void
+record_free (void *ptr)
+{
+  if (ptr)
+    counts.frees++;
+}
+
+}; // lldc::testing::alloc
+
+namespace ALLOC = lldc::testing::alloc;
+
+#if defined(__GLIBC__)
+extern "C" {
+
+void*
+malloc (size_t size) noexcept
+{
+  ALLOC::record(size);
+  return __libc_malloc(size);
+}
+
+void*
+calloc (size_t count, size_t size) noexcept
+{
+  ALLOC::record(count * size);
+  return __libc_calloc(count, size);
+}
+
+void*
+realloc (void *ptr, size_t size) noexcept
+{
+  if (size)
+    ALLOC::record(size);
+  if (ptr && !size)
+    ALLOC::record_free(ptr);
+  return __libc_realloc(ptr, size);
+}
+
+void
+free (void *ptr) noexcept
+{
+  ALLOC::record_free(ptr);
+  __libc_free(ptr);
+}
+
+}; // extern "C"
+#endif
+
+static void*
+counted_new (size_t size)
+{
+  ALLOC::record(size);
+  if (void *ptr = RAW_MALLOC(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+static void
+counted_delete (void *ptr) noexcept
+{
+  ALLOC::record_free(ptr);
+  RAW_FREE(ptr);
+}
+
+void* operator new (size_t size) { return counted_new(size); }
+void* operator new[] (size_t size) { return counted_new(size); }
+void* operator new (size_t size, const std::nothrow_t &) noexcept {
+  try { return counted_new(size); } catch (...) { return nullptr; }
+}
+void* operator new[] (size_t size, const std::nothrow_t &) noexcept {
+  try { return counted_new(size); } catch (...) { return nullptr; }
+}
+
+void operator delete (void *ptr) noexcept { counted_delete(ptr); }
+void operator delete[] (void *ptr) noexcept { counted_delete(ptr); }
+void operator delete (void *ptr, size_t) noexcept { counted_delete(ptr); }
+void operator delete[] (void *ptr, size_t) noexcept { counted_delete(ptr); }
+void operator delete (void *ptr, const std::nothrow_t &) noexcept { counted_delete(ptr); }
+void operator delete[] (void *ptr, const std::nothrow_t &) noexcept { counted_delete(ptr); }
@@ -0,0 +1,41 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * Allocation accounting for tests and benchmarks.  Linking this library
+ * replaces the global operator new/delete and, with glibc, interposes
+ * malloc/calloc/realloc/free (which is where g_malloc ends up), counting
+ * each allocation made by the calling thread.
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace lldc::testing::alloc {
+
+struct Counts {
+  size_t allocations = 0;
+  size_t bytes = 0;
+  size_t frees = 0;
+
+  Counts operator-(const Counts &rhs) const {
+    return Counts{allocations - rhs.allocations, bytes - rhs.bytes, frees - rhs.frees};
+  }
+};
+
+/**
+ * @brief The calling thread's running totals.
+ */
+Counts current();
+
+/**
+ * @brief What the calling thread allocated while running f.
+ */
+template <typename F>
+Counts measure(F &&f) {
+  const Counts before = current();
+  f();
+  return current() - before;
+}
+
+}; // lldc::testing::alloc
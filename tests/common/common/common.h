@@ -3,5 +3,6 @@
 #define __COMMON_TEST_INSIDE__
 
 #include <common/example_messages.h>
+#include <common/example_content.h>
 
 #undef __COMMON_TEST_INSIDE__
@@ -0,0 +1,118 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ */
+#pragma once
+
+#if !defined(__COMMON_TEST_INSIDE__) && !defined(COMMON_TEST_COMPILATION)
+#error "Only <common/common.h> can be included directly."
+#endif
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/example_messages.h"
+
+namespace lldc::testing {
+
+/**
+ * @brief Fill each example message with representative content, for the
+ * benchmarks and allocation budgets.  Members are set away from their
+ * defaults so that nothing is skipped as optional.
+ */
+inline void
+fill_example (FirstMessage &msg)
+{
+  for (int i = 0; i < 8; i++)
+    msg.body.data["key-" + std::to_string(i)] = "value-" + std::to_string(i);
+}
+
+inline void
+fill_example (SecondMessage &msg)
+{
+  msg.some_bool   = true;
+  msg.some_char   =  'A';
+  msg.some_string = "something";
+  msg.some_float  = 500.0F;
+  msg.some_double = 1200.1;
+  msg.some_uint8  = (uint8_t)  0x01;
+  msg.some_uint16 = (uint16_t) 0x2345;
+  msg.some_uint32 = (uint32_t) 0x6789ABCD;
+  msg.some_uint64 = (uint64_t) 0xEF0123456789ABCD;
+  msg.some_int8   = (int8_t)   0xFE;
+  msg.some_int16  = (int16_t)  0xDCBA;
+  msg.some_int32  = (int32_t)  0x98765432;
+  msg.some_int64  = (int64_t)  0x10FEDCBA98765432;
+}
+
+inline void
+fill_example (OptionalMemberMessage &msg)
+{
+  msg.optional_string = "optional";
+  msg.required_string = "required";
+  for (uint64_t i = 0; i < 16; i++) {
+    msg.optional_vector.push_back(i);
+    msg.required_vector.push_back(i << 32);
+  }
+  for (uint64_t i = 0; i < 8; i++) {
+    msg.optional_map["key-" + std::to_string(i)] = i;
+    msg.required_map["key-" + std::to_string(i)] = i << 32;
+  }
+  msg.optional_defaulted_uint64 = OptionalMemberMessage::DEFAULT_U64_VALUE + 1;
+  msg.optional_sptr = std::make_shared<OptionalMemberMessage::Payload>();
+  msg.optional_sptr->value = 1;
+  msg.required_sptr = std::make_shared<OptionalMemberMessage::Payload>();
+  msg.required_sptr->value = 2;
+  msg.optional_rawptr = new OptionalMemberMessage::Payload();
+  msg.optional_rawptr->value = 3;
+  msg.required_rawptr = new OptionalMemberMessage::Payload();
+  msg.required_rawptr->value = 4;
+  msg.optional_obj.value = 5;
+  msg.required_obj.value = 6;
+}
+
+inline void
+fill_example (SimpleMessage &msg)
+{
+  msg.name = "simple";
+  msg.payload.member = "unregistered";
+}
+
+inline void
+fill_example (MessageWithAnys &msg)
+{
+  msg.properties["int-valued"] = (int) 1234;
+  msg.properties["string-valued"] = std::string("something");
+  msg.properties["double-valued"] = 12.5;
+}
+
+inline void
+fill_example (MessageWithVectors &msg)
+{
+  for (int i = 0; i < 64; i++)
+    msg.v_int.push_back(i);
+  msg.vv_int.resize(8);
+  for (auto &v : msg.vv_int)
+    v = std::vector<int>(8, 42);
+  for (int i = 0; i < 4; i++) {
+    auto item = std::make_shared<SimpleMessage>();
+    fill_example(*item);
+    msg.v_sptr.push_back(item);
+    msg.v_obj.push_back(*item);
+  }
+}
+
+inline void
+fill_example (MessageWithBlob &msg)
+{
+  msg.payload = R"({"value":5,"list":[1,2,3],"nested":{"name":"blob"}})";
+}
+
+inline void
+fill_example (MaybeEmpty &msg)
+{
+  msg.value = MaybeEmpty::DEFAULT_VALUE + 1;
+}
+
+}; // lldc::testing
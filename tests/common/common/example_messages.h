@@ -14,9 +14,11 @@
 #pragma once
 
 #include <common/api.h>
+#include <lldc-reflection/blob.h>
 #include <lldc-reflection/declaration.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <any>
@@ -300,6 +302,74 @@ struct COMMON_TEST_API
   RTTR_ENABLE();
 };
 
+/**
+ * @brief Every member is registered with in_place_property, so the converters read and
+ * write them directly: scalars (two of them of the same type), a defaulted scalar, a
+ * container and a nested object.
+ */
+struct COMMON_TEST_API
+MessageWithMemberAccess {
+  static const uint64_t DEFAULT_COUNT;
+
+  int32_t first = 0;
+  int32_t second = 0;
+  std::string name;
+  double ratio = 0.0;
+  uint64_t count = DEFAULT_COUNT;
+  std::vector<int> values;
+  SimpleMessage nested;
+
+  RTTR_ENABLE();
+};
+
+/**
+ * @brief The 'payload' member is registered as a blob, so it is converted as the
+ * intermediate type's own representation of the (JSON) string rather than as a
+ * plain string member.
+ */
+struct COMMON_TEST_API
+MessageWithBlob {
+  std::string payload;
+
+  RTTR_ENABLE();
+};
+
+/**
+ * @brief Registered with a member access that does not fit its property ('vv-int' is
+ * given v_int's), which the converters must ignore rather than use.
+ */
+struct COMMON_TEST_API
+MessageWithMismatchedAccess {
+  std::vector<int> v_int;
+  std::vector<std::vector<int>> vv_int;
+
+  RTTR_ENABLE();
+};
+
+/**
+ * @brief A blob held in a shared, immutable buffer, which the converters that can
+ * (socket.io's binary messages) share rather than copy.
+ */
+struct COMMON_TEST_API
+MessageWithSharedBlob {
+  std::shared_ptr<const std::string> attachment;
+
+  RTTR_ENABLE();
+};
+
+/**
+ * @brief As MessageWithBlob, with the payload kept as a Blob, which passes through
+ * as the converter read it and is decoded later (its 'kind' telling into what).
+ */
+struct COMMON_TEST_API
+MessageWithBlobValue {
+  std::string kind;
+  ::lldc::reflection::Blob payload;
+  std::vector<::lldc::reflection::Blob> extras;
+
+  RTTR_ENABLE();
+};
+
 struct COMMON_TEST_API
   MaybeEmpty {
     static const int32_t DEFAULT_VALUE;
@@ -0,0 +1,139 @@
+/**
+ * Copyright 2023 Laerdal Labs, DC
+ *   Author: Thomas Goodwin <thomas.goodwin@laerdal.com>
+ *
+ * The converter under test, for the tests, benchmarks and allocation budgets,
+ * which are built once per converter: one of TEST_JSON_GLIB, TEST_SOCKET_IO or
+ * TEST_JSON selects it.
+ */
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if TEST_JSON_GLIB
+  #include <lldc-reflection/converters/json-glib.h>
+  #define to_conversion lldc::reflection::converters::to_json_glib
+  #define from_conversion lldc::reflection::converters::from_json_glib
+  #define to_batch_conversion lldc::reflection::converters::to_json_glib_batch
+  #define from_batch_conversion lldc::reflection::converters::from_json_glib_batch
+  #define to_async_conversion lldc::reflection::converters::to_json_glib_async
+  #define uut_type JsonNode*
+  #define uut_unref(t) {if (t) json_node_unref(t);}
+
+#elif TEST_SOCKET_IO
+  #include <lldc-reflection/converters/socket-io.h>
+  #define to_conversion lldc::reflection::converters::to_socket_io
+  #define from_conversion lldc::reflection::converters::from_socket_io
+  #define to_batch_conversion lldc::reflection::converters::to_socket_io_batch
+  #define from_batch_conversion lldc::reflection::converters::from_socket_io_batch
+  #define to_async_conversion lldc::reflection::converters::to_socket_io_async
+  #define uut_type sio::message::ptr
+  #define uut_unref(t) t.reset()
+
+#elif TEST_JSON
+  #include <lldc-reflection/converters/json.h>
+
+  // The JSON text, standing in for the other converters' node/message pointers.
+  struct JsonText {
+    JsonText(std::nullptr_t = nullptr) {}
+    JsonText(std::string value) : text(std::move(value)) {}
+    explicit operator bool() const { return !text.empty(); }
+    bool operator!=(std::nullptr_t) const { return !text.empty(); }
+    std::string text;
+  };
+
+  inline bool from_json_text(const JsonText &t, ::rttr::instance obj) {
+    return lldc::reflection::converters::json::from_json(t.text, obj);
+  }
+
+  inline bool from_json_text(const JsonText &t, ::rttr::instance obj, lldc::reflection::ConversionResult &result) {
+    return lldc::reflection::converters::json::from_json(t.text, obj, result);
+  }
+
+  inline std::vector<bool> from_json_text_batch(std::span<const JsonText> texts, std::span<const ::rttr::instance> objects) {
+    std::vector<std::string_view> views;
+    views.reserve(texts.size());
+    for (const auto &t : texts)
+      views.push_back(t.text);
+    return lldc::reflection::converters::json::from_json_batch(views, objects);
+  }
+
+  #define to_conversion lldc::reflection::converters::json::to_json
+  #define from_conversion from_json_text
+  #define to_batch_conversion lldc::reflection::converters::json::to_json_batch
+  #define from_batch_conversion from_json_text_batch
+  #define to_async_conversion lldc::reflection::converters::json::to_json_async
+  #define uut_type JsonText
+  #define uut_unref(t) t = {}
+
+#else
+  #error Must define a test type
+#endif
+
+/**
+ * @brief The size of the converted message, for bytes/op: the JSON text for
+ * the JSON converters, and for SocketIO the payload it carries (keys, strings,
+ * binaries and 8 bytes per number) rather than any packet encoding of it.
+ */
+#if TEST_JSON_GLIB
+inline size_t
+uut_size (JsonNode *node)
+{
+  gsize length = 0;
+  JsonGenerator *generator = json_generator_new();
+  json_generator_set_root(generator, node);
+  gchar *text = json_generator_to_data(generator, &length);
+  g_free(text);
+  g_object_unref(generator);
+  return length;
+}
+
+#elif TEST_SOCKET_IO
+inline size_t
+uut_size (const sio::message::ptr &msg)
+{
+  size_t size = 0;
+
+  if (!msg)
+    return size;
+
+  switch (msg->get_flag()) {
+    case sio::message::flag_integer:
+    case sio::message::flag_double:
+      size = 8;
+      break;
+    case sio::message::flag_boolean:
+      size = 1;
+      break;
+    case sio::message::flag_string:
+      size = msg->get_string().size();
+      break;
+    case sio::message::flag_binary:
+      size = (msg->get_binary()) ? msg->get_binary()->size() : 0;
+      break;
+    case sio::message::flag_array:
+      for (const auto &item : msg->get_vector())
+        size += uut_size(item);
+      break;
+    case sio::message::flag_object:
+      for (const auto &item : msg->get_map())
+        size += item.first.size() + uut_size(item.second);
+      break;
+    default:
+      break;
+  }
+
+  return size;
+}
+
+#elif TEST_JSON
+inline size_t
+uut_size (const JsonText &t)
+{
+  return t.text.size();
+}
+#endif
@@ -29,6 +29,8 @@ namespace lldc::testing {
 
   const uint64_t OptionalMemberMessage::DEFAULT_U64_VALUE = 86;
 
+  const uint64_t MessageWithMemberAccess::DEFAULT_COUNT = 7;
+
   const int32_t MaybeEmpty::DEFAULT_VALUE = 32;
 };
 
@@ -173,6 +175,39 @@ RTTR_PLUGIN_REGISTRATION {
     .property("v-obj", &T::MessageWithVectors::v_obj)
     ;
 
+  auto member_access = ::rttr::registration::class_<T::MessageWithMemberAccess>("message-with-member-access");
+  ::lldc::reflection::in_place_property(member_access, "first", &T::MessageWithMemberAccess::first);
+  ::lldc::reflection::in_place_property(member_access, "second", &T::MessageWithMemberAccess::second);
+  ::lldc::reflection::in_place_property(member_access, "name", &T::MessageWithMemberAccess::name);
+  ::lldc::reflection::in_place_property(member_access, "ratio", &T::MessageWithMemberAccess::ratio);
+  ::lldc::reflection::in_place_property(member_access, "count", &T::MessageWithMemberAccess::count,
+    ::lldc::reflection::metadata::set_is_optional_with_default(T::MessageWithMemberAccess::DEFAULT_COUNT));
+  ::lldc::reflection::in_place_property(member_access, "values", &T::MessageWithMemberAccess::values);
+  ::lldc::reflection::in_place_property(member_access, "nested", &T::MessageWithMemberAccess::nested);
+
+  auto blob = ::rttr::registration::class_<T::MessageWithBlob>("message-with-blob");
+  ::lldc::reflection::in_place_property(blob, "payload", &T::MessageWithBlob::payload,
+    ::lldc::reflection::metadata::set_is_blob());
+
+  ::rttr::registration::class_<T::MessageWithMismatchedAccess>("message-with-mismatched-access")
+    .property("v-int", &T::MessageWithMismatchedAccess::v_int)
+    // Attached directly, as in_place_property would not allow, to name the wrong member.
+    .property("vv-int", &T::MessageWithMismatchedAccess::vv_int)
+      (::lldc::reflection::metadata::detail::set_member_access(&T::MessageWithMismatchedAccess::v_int))
+    ;
+
+  ::rttr::registration::class_<T::MessageWithSharedBlob>("message-with-shared-blob")
+    .property("attachment", &T::MessageWithSharedBlob::attachment)
+      (::lldc::reflection::metadata::set_is_blob())
+    ;
+
+  ::rttr::registration::class_<T::MessageWithBlobValue>("message-with-blob-value")
+    .property("kind", &T::MessageWithBlobValue::kind)
+    .property("payload", &T::MessageWithBlobValue::payload)
+    .property("extras", &T::MessageWithBlobValue::extras)
+      (::lldc::reflection::metadata::set_is_optional())
+    ;
+
   ::rttr::registration::class_<T::MaybeEmpty>("maybe-empty")
     .property("value", &T::MaybeEmpty::value)
       (::lldc::reflection::metadata::set_is_optional_with_default(T::MaybeEmpty::DEFAULT_VALUE))
@@ -1,22 +1,19 @@
+#include <future>
+#include <limits>
+#include <span>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <common/common.h>
+#include <common/uut.h>
+#include <lldc-reflection/batch.h>
+#include <lldc-reflection/stats.h>
+#include <lldc-reflection/trace.h>
 
 #if TEST_JSON_GLIB
-  #include <lldc-reflection/converters/json-glib.h>
-  #define to_conversion lldc::reflection::converters::to_json_glib
-  #define from_conversion lldc::reflection::converters::from_json_glib
-  #define uut_type JsonNode*
-  #define uut_unref(t) {if (t) json_node_unref(t);}
-
-#elif TEST_SOCKET_IO
-  #include <lldc-reflection/converters/socket-io.h>
-  #define to_conversion lldc::reflection::converters::to_socket_io
-  #define from_conversion lldc::reflection::converters::from_socket_io
-  #define uut_type sio::message::ptr
-  #define uut_unref(t) t.reset()
-
-#else
-  #error Must define a test type
+  // For comparing the native JSON converter's output with json-glib's.
+  #include <lldc-reflection/converters/json.h>
 #endif
 
 using namespace lldc::testing;
@@ -32,6 +29,10 @@ static bool member_check_function(T ref, const std::string& name) {
 #elif TEST_SOCKET_IO
   auto ref_obj = ref->get_map();
   result = (ref_obj.end() != ref_obj.find(name));
+
+#elif TEST_JSON
+  // The members checked for are not also the names of nested members.
+  result = (std::string::npos != ref.text.find("\"" + name + "\":"));
 #endif
 
   return result;
@@ -178,6 +179,30 @@ TEST(Examples, SecondMessage) {
   uut_unref(temp);
 }
 
+TEST(Examples, UnsignedLimits) {
+  /**
+   * The largest uint64 round-trips, and the native JSON converter writes it
+   * as the unsigned decimal rather than by its bit pattern (i.e., -1).
+   */
+  SecondMessage input, output;
+  uut_type temp = nullptr;
+
+  input.some_uint64 = std::numeric_limits<uint64_t>::max();
+  input.some_int64  = std::numeric_limits<int64_t>::min();
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), output.some_uint64);
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), output.some_int64);
+
+#if TEST_JSON
+  EXPECT_NE(std::string::npos, temp.text.find("\"some_uint64\":18446744073709551615"));
+  EXPECT_NE(std::string::npos, temp.text.find("\"some_int64\":-9223372036854775808"));
+#endif
+
+  uut_unref(temp);
+}
+
 /**
   * @brief The 'payload' member of SimpleMessage is registered, but the Payload 'member' is not.
   * Therefore when converting 'to' an intermediate type, the result should be an empty object
@@ -206,8 +231,148 @@ TEST(Examples, PropertyRegistrationBehavior) {
   auto ref_obj = temp->get_map();
   auto payload_obj = ref_obj["payload"]->get_map();
   EXPECT_EQ(0, payload_obj.size());
+
+#elif TEST_JSON
+  EXPECT_NE(std::string::npos, temp.text.find("\"payload\":{}"));
+#endif
+
+  uut_unref(temp);
+}
+
+/**
+  * @brief Members of the intermediate type that do not map to a registered property are
+  * skipped without failing the conversion, regardless of where they appear.
+  */
+TEST(Examples, UnknownMembersAreSkipped) {
+  SecondMessage input, output;
+  uut_type temp = nullptr;
+
+  input.some_string = "known";
+  input.some_int32 = 42;
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  ASSERT_TRUE(temp);
+
+#if TEST_JSON_GLIB
+  json_object_set_string_member(json_node_get_object(temp), "aaa_unknown", "first");
+  json_object_set_int_member(json_node_get_object(temp), "zzz_unknown", 5);
+#elif TEST_SOCKET_IO
+  temp->get_map()["aaa_unknown"] = ::sio::string_message::create("first");
+  temp->get_map()["zzz_unknown"] = ::sio::int_message::create(5);
+#elif TEST_JSON
+  temp.text.insert(1, R"("aaa_unknown" : "first", )");
+  temp.text.insert(temp.text.size() - 1, R"(, "zzz_unknown": {"a": [1, 2.5e3, null, true, {}]})");
+#endif
+
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ(input, output);
+
+  uut_unref(temp);
+}
+
+#if TEST_JSON
+/**
+  * @brief Text that is not (exactly) one JSON object fails the conversion.
+  */
+TEST(Examples, MalformedTextFails) {
+  SecondMessage output;
+  const std::vector<std::string> malformed = {
+    "",
+    "[]",
+    R"({"some_string": "unterminated)",
+    R"({"some_string": "x",})",
+    R"({"some_string": "x" "some_int32": 1})",
+    R"({"some_int32": 1} trailing)",
+    R"({"unknown": [1, 2,]})",
+  };
+
+  for (auto const& text : malformed) {
+    EXPECT_FALSE(lldc::reflection::converters::json::from_json(text, output)) <<
+      "Accepted: " << text;
+  }
+}
+
+TEST(Errors, ReportsWhereTextIsMalformed) {
+  MessageWithVectors output;
+  lldc::reflection::ConversionResult result;
+
+  EXPECT_FALSE(lldc::reflection::converters::json::from_json(
+    R"({"v-int": [1, 2], "vv-int": [[1], [2, 3 4]]})", output, result));
+  EXPECT_EQ(lldc::reflection::ConversionError::malformed, result.error);
+  EXPECT_EQ("/vv-int[1]", result.path);
+
+  EXPECT_FALSE(lldc::reflection::converters::json::from_json("[]", output, result));
+  EXPECT_EQ(lldc::reflection::ConversionError::not_an_object, result.error);
+  EXPECT_EQ("", result.path);
+}
+#endif
+
+TEST(Errors, ReportsPathOfMissingMember) {
+  /**
+   * A required member missing deep inside the message is reported, with
+   * the path to it, rather than thrown.
+   */
+  MessageWithVectors input, output;
+  lldc::reflection::ConversionResult result;
+  uut_type temp = nullptr;
+
+  input.v_obj.resize(3);
+  for (auto &obj : input.v_obj)
+    obj.name = "x";
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  ASSERT_TRUE(temp);
+
+  // Remove the last v-obj element's 'name'.
+#if TEST_JSON_GLIB
+  JsonArray *v_obj = json_object_get_array_member(json_node_get_object(temp), "v-obj");
+  json_object_remove_member(json_array_get_object_element(v_obj, 2), "name");
+  EXPECT_FALSE(lldc::reflection::converters::from_json_glib(temp, output, result));
+
+#elif TEST_SOCKET_IO
+  temp->get_map()["v-obj"]->get_vector()[2]->get_map().erase("name");
+  EXPECT_FALSE(lldc::reflection::converters::from_socket_io(temp, output, result));
+
+#elif TEST_JSON
+  const std::string name = R"("name":"x",)";
+  temp.text.erase(temp.text.rfind(name), name.size());
+  EXPECT_FALSE(lldc::reflection::converters::json::from_json(temp.text, output, result));
+#endif
+
+  EXPECT_FALSE(result);
+  EXPECT_EQ(lldc::reflection::ConversionError::missing_member, result.error);
+  EXPECT_EQ("/v-obj[2]/name", result.path);
+
+  uut_unref(temp);
+}
+
+TEST(Errors, CountsUnknownMembers) {
+  /**
+   * Members that match no property are skipped, and counted, in the same
+   * pass that finds the others.
+   */
+  SimpleMessage input, output;
+  lldc::reflection::ConversionResult result;
+  uut_type temp = nullptr;
+
+  input.name = "known";
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  ASSERT_TRUE(temp);
+
+#if TEST_JSON_GLIB
+  json_object_set_int_member(json_node_get_object(temp), "extra-1", 1);
+  json_object_set_string_member(json_node_get_object(temp), "extra-2", "x");
+#elif TEST_SOCKET_IO
+  temp->get_map()["extra-1"] = ::sio::int_message::create(1);
+  temp->get_map()["extra-2"] = ::sio::string_message::create("x");
+#elif TEST_JSON
+  temp.text.insert(1, R"("extra-1":1,"extra-2":"x",)");
 #endif
 
+  EXPECT_TRUE(from_conversion(temp, output, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(2u, result.unknown_members);
+  EXPECT_EQ(input.name, output.name);
+
   uut_unref(temp);
 }
 
@@ -287,6 +452,8 @@ TEST(Optionals, MissingRequiredWillFail) {
   temp = json_from_string("{}", NULL);
 #elif TEST_SOCKET_IO
   temp = ::sio::object_message::create();
+#elif TEST_JSON
+  temp = std::string("{}");
 #endif
   EXPECT_FALSE(from_conversion(temp, output));
   uut_unref(temp);
@@ -431,6 +598,216 @@ TEST(Optionals, EmptyBecauseOptional) {
   uut_unref(temp);
 }
 
+TEST(Blob, RoundTrip) {
+  /**
+   * The blob member is converted as the intermediate type's representation
+   * of the payload (JSON object, binary message) and restored as a string.
+   */
+  MessageWithBlob input, output;
+  uut_type temp = nullptr;
+
+  input.payload = R"({"value":5})";
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(member_check_function(temp, "payload"));
+  EXPECT_TRUE(from_conversion(temp, output));
+
+#if TEST_JSON_GLIB
+  auto ref_obj = json_node_get_object(temp);
+  EXPECT_TRUE(JSON_NODE_HOLDS_OBJECT(json_object_get_member(ref_obj, "payload")));
+
+  // The string member receives the blob's text as json-glib pretty-prints it.
+  gchar *pretty = json_to_string(json_object_get_member(ref_obj, "payload"), TRUE);
+  EXPECT_EQ(std::string(pretty), output.payload);
+  g_free(pretty);
+
+  OptionalMemberMessage::Payload payload;
+  EXPECT_TRUE(lldc::reflection::converters::json_glib::from_json(output.payload, payload));
+  EXPECT_EQ(5, payload.value);
+
+#elif TEST_SOCKET_IO
+  auto ref_obj = temp->get_map();
+  EXPECT_EQ(::sio::message::flag_binary, ref_obj["payload"]->get_flag());
+  EXPECT_EQ(input.payload, output.payload);
+
+#elif TEST_JSON
+  EXPECT_NE(std::string::npos, temp.text.find(R"("payload":{"value":5})"));
+  EXPECT_EQ(input.payload, output.payload);
+#endif
+
+  uut_unref(temp);
+}
+
+TEST(Blob, ValuePassesThrough) {
+  /**
+   * A Blob member is kept as the converter read it, written back as it was,
+   * and decoded into its type on demand.  An empty one is null.
+   */
+  using lldc::reflection::Blob;
+  MessageWithBlobValue input, middle, output;
+  uut_type temp = nullptr;
+  uut_type again = nullptr;
+
+  input.kind = "payload";
+  input.payload = Blob(R"({"value": 5})");
+  input.extras = {Blob("[1,2]"), Blob(R"({"value":6})")};
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(from_conversion(temp, middle));
+  EXPECT_EQ(input.kind, middle.kind);
+  ASSERT_FALSE(middle.payload.empty());
+  ASSERT_EQ(2u, middle.extras.size());
+  EXPECT_EQ("[1,2]", middle.extras[0].text());
+
+  // Written again without being looked at, then decoded.
+  EXPECT_NO_THROW(again = to_conversion(middle));
+  EXPECT_TRUE(from_conversion(again, output));
+#if TEST_JSON
+  EXPECT_EQ(temp.text, again.text);
+#endif
+
+  OptionalMemberMessage::Payload payload;
+  EXPECT_TRUE(output.payload.decode(payload));
+  EXPECT_EQ(5, payload.value);
+  EXPECT_TRUE(output.extras[1].decode(payload));
+  EXPECT_EQ(6, payload.value);
+  EXPECT_FALSE(output.extras[0].decode(payload)); // not an object
+  uut_unref(temp);
+  uut_unref(again);
+
+  MessageWithBlobValue empty, empty_output;
+  empty_output.payload = Blob("{}");
+  EXPECT_NO_THROW(temp = to_conversion(empty));
+  EXPECT_TRUE(from_conversion(temp, empty_output));
+  EXPECT_TRUE(empty_output.payload.empty());
+  uut_unref(temp);
+}
+
+TEST(Blob, SharedBufferIsNotCopied) {
+  /**
+   * A shared buffer blob goes into (and comes back out of) socket.io binary
+   * messages as the same buffer; the other converters copy its content.
+   */
+  MessageWithSharedBlob input, output;
+  uut_type temp = nullptr;
+
+  input.attachment = std::make_shared<const std::string>(R"({"value":5})");
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(from_conversion(temp, output));
+  ASSERT_TRUE(output.attachment);
+  EXPECT_EQ(*input.attachment, *output.attachment);
+
+#if TEST_SOCKET_IO
+  EXPECT_EQ(input.attachment.get(), temp->get_map()["attachment"]->get_binary().get());
+  EXPECT_EQ(input.attachment.get(), output.attachment.get());
+#endif
+
+  uut_unref(temp);
+
+  // A null buffer is null, and reads back as one.
+  MessageWithSharedBlob empty;
+  EXPECT_NO_THROW(temp = to_conversion(empty));
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_FALSE(output.attachment);
+  uut_unref(temp);
+}
+
+#if TEST_SOCKET_IO
+TEST(SocketIO, ConsumingMovesStrings) {
+  /**
+   * Converting from an rvalue message moves its strings into the object,
+   * except where part of it is also held elsewhere.
+   */
+  SimpleMessage input, copied, moved;
+  uut_type temp = nullptr;
+
+  input.name = std::string(64, 'n'); // longer than any short string buffer
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  ASSERT_TRUE(temp);
+
+  // Both the message and its 'name' are also held here, so are copied from.
+  auto name = temp->get_map().at("name");
+  EXPECT_TRUE(lldc::reflection::converters::from_socket_io(::sio::message::ptr(temp), copied));
+  EXPECT_EQ(input.name, copied.name);
+  EXPECT_EQ(input.name, name->get_string());
+
+  const char *data = name->get_string().data();
+  name.reset();
+  EXPECT_TRUE(lldc::reflection::converters::from_socket_io(std::move(temp), moved));
+  EXPECT_EQ(input.name, moved.name);
+  EXPECT_EQ(data, moved.name.data());
+  EXPECT_FALSE(temp); // taken over by the conversion
+}
+#endif
+
+#if TEST_JSON_GLIB
+TEST(NativeJson, MatchesJsonGlib) {
+  /**
+   * The native writer produces the same document as the json-glib converter,
+   * whether it's returned whole or passed to a sink in chunks.
+   */
+  SecondMessage input;
+  uut_type temp = nullptr;
+
+  input.some_bool   = true;
+  input.some_string = "quote \" and \\ and \n";
+  input.some_float  = 500.0F;
+  input.some_double = 1200.1;
+  input.some_uint64 = (uint64_t) 0xEF0123456789ABCD;
+  input.some_int8   = (int8_t)   0xFE;
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  ASSERT_TRUE(temp);
+
+  std::string text = lldc::reflection::converters::json::to_json(input);
+  JsonNode *native = json_from_string(text.c_str(), nullptr);
+  ASSERT_TRUE(native);
+  EXPECT_TRUE(json_node_equal(temp, native));
+  json_node_unref(native);
+
+  std::string chunks;
+  EXPECT_TRUE(lldc::reflection::converters::json::to_json(input,
+    [&chunks](std::string_view chunk) { chunks += chunk; }));
+  EXPECT_EQ(text, chunks);
+
+  uut_unref(temp);
+}
+
+TEST(JsonGlibText, CompactIntoReusedBuffers) {
+  /**
+   * The json-glib text functions write pretty or compact text into the
+   * caller's std::string or GString, and read from views or bytes.
+   */
+  namespace JSON_GLIB = lldc::reflection::converters::json_glib;
+  SecondMessage input, output;
+
+  input.some_bool   = true;
+  input.some_string = "quote \" and \\ and \n";
+  input.some_double = 1200.1;
+
+  const std::string pretty = JSON_GLIB::to_json(input);
+  std::string compact = "stale";
+  EXPECT_TRUE(JSON_GLIB::to_json(input, compact, JSON_GLIB::Layout::compact));
+  EXPECT_LT(compact.size(), pretty.size());
+  EXPECT_EQ(std::string::npos, compact.find('\n'));
+
+  GString *text = g_string_new("stale");
+  EXPECT_TRUE(JSON_GLIB::to_json(input, text, JSON_GLIB::Layout::compact));
+  EXPECT_EQ(compact, std::string(text->str, text->len));
+  g_string_free(text, TRUE);
+
+  EXPECT_TRUE(JSON_GLIB::from_json(std::string_view(compact), output));
+  EXPECT_EQ(input.some_string, output.some_string);
+  output.some_string.clear();
+  EXPECT_TRUE(JSON_GLIB::from_json(std::as_bytes(std::span(pretty)), output));
+  EXPECT_EQ(input.some_string, output.some_string);
+
+  EXPECT_FALSE(JSON_GLIB::from_json(std::string_view(compact).substr(0, compact.size() / 2), output));
+  EXPECT_FALSE(JSON_GLIB::from_json(std::string_view(), output));
+}
+#endif
+
 TEST(StdAny, MapWithAny) {
   /**
    * The object has a parameter, 'properties' which is a std::map<std::string, std::any>.
@@ -521,6 +898,108 @@ TEST(Vectors, VectorOfValues) {
   uut_unref(temp);
 }
 
+TEST(Vectors, MismatchedMemberAccessIsIgnored) {
+  /**
+   * A member access registered on the wrong property is not used, so each
+   * property still reads and writes its own member.
+   */
+  MessageWithMismatchedAccess input, output;
+  uut_type temp = nullptr;
+
+  input.v_int = { 1, 2, 3 };
+  input.vv_int = { { 4, 5 }, { 6 } };
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(temp);
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ(input.v_int, output.v_int);
+  EXPECT_EQ(input.vv_int, output.vv_int);
+
+  uut_unref(temp);
+}
+
+/**
+  * @brief The integer value of the named member of the converted object, to check
+  * what was written without reading it back through the converter.
+  */
+static int64_t member_integer(uut_type &ref, const std::string &name) {
+#if TEST_JSON_GLIB
+  return json_object_get_int_member(json_node_get_object(ref), name.c_str());
+
+#elif TEST_SOCKET_IO
+  return ref->get_map().at(name)->get_int();
+
+#elif TEST_JSON
+  const auto at = ref.text.find("\"" + name + "\":");
+  return (at == std::string::npos) ? -1 : std::stoll(ref.text.substr(at + name.size() + 3));
+#endif
+}
+
+TEST(MemberAccess, RoundTrip) {
+  /**
+   * Members registered with in_place_property are written from, and read
+   * into, the object directly.
+   */
+  MessageWithMemberAccess input, output;
+  uut_type temp = nullptr;
+
+  input.first = 1;
+  input.second = 2;
+  input.name = "in place";
+  input.ratio = 0.5;
+  input.count = 50 + MessageWithMemberAccess::DEFAULT_COUNT;
+  input.values = { 3, 4, 5 };
+  input.nested.name = "nested";
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(member_check_function(temp, "count"));
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ(input.first, output.first);
+  EXPECT_EQ(input.second, output.second);
+  EXPECT_EQ(input.name, output.name);
+  EXPECT_EQ(input.ratio, output.ratio);
+  EXPECT_EQ(input.count, output.count);
+  EXPECT_EQ(input.values, output.values);
+  EXPECT_EQ(input.nested.name, output.nested.name);
+
+  uut_unref(temp);
+}
+
+TEST(MemberAccess, DefaultedMemberIsSkipped) {
+  MessageWithMemberAccess input, output;
+  uut_type temp = nullptr;
+
+  output.count = 0;
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_FALSE(member_check_function(temp, "count"));
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ(0u, output.count);
+
+  uut_unref(temp);
+}
+
+TEST(MemberAccess, SiblingsOfTheSameType) {
+  /**
+   * Each property reads and writes its own member rather than another of the
+   * same type.  What was written is checked in the converted object itself,
+   * as members swapped both ways would still round-trip.
+   */
+  MessageWithMemberAccess input, output;
+  uut_type temp = nullptr;
+
+  input.first = 1;
+  input.second = 2;
+
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_EQ(1, member_integer(temp, "first"));
+  EXPECT_EQ(2, member_integer(temp, "second"));
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ(1, output.first);
+  EXPECT_EQ(2, output.second);
+
+  uut_unref(temp);
+}
+
 TEST(Vectors, VectorOfVectorOfValues) {
   MessageWithVectors input, output;
   uut_type temp = nullptr;
@@ -567,6 +1046,256 @@ TEST(Vectors, VectorOfValueObjects) {
   uut_unref(temp);
 }
 
+TEST(Concurrency, ParallelRoundTrips) {
+  /**
+   * Threads converting distinct messages at the same time, half of them with
+   * a context of their own and half with their thread's default, each get
+   * their own message back.
+   */
+  const int thread_count = 8;
+  const int round_trips = 200;
+  std::vector<int> failures(thread_count, 0);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < thread_count; t++) {
+    threads.emplace_back([t, &failures] {
+      lldc::reflection::ConversionContext own;
+      auto &context = (t % 2) ? own : lldc::reflection::ConversionContext::this_thread();
+
+      for (int i = 0; i < round_trips; i++) {
+        SecondMessage input, output;
+        input.some_string = "thread " + std::to_string(t) + " message " + std::to_string(i);
+        input.some_double = t * 1000.0 + i;
+
+        uut_type temp = to_conversion(input, context);
+        if (!temp || !from_conversion(temp, output) ||
+            input.some_string != output.some_string || input.some_double != output.some_double)
+          failures[t]++;
+        uut_unref(temp);
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+  for (int t = 0; t < thread_count; t++)
+    EXPECT_EQ(0, failures[t]) << "thread " << t;
+}
+
+TEST(Vectors, SplitLargeArray) {
+  /**
+   * Arrays at or above the split threshold are written in chunks on several
+   * threads; the result is the same as writing them in one go.
+   */
+  MessageWithVectors input, serial_output, split_output;
+  uut_type serial = nullptr;
+  uut_type split = nullptr;
+
+  for (int i = 0; i < 5000; i++) {
+    input.v_int.push_back(i);
+    input.v_obj.emplace_back();
+    input.v_obj.back().name = "element " + std::to_string(i);
+  }
+
+  const size_t threshold = lldc::reflection::batch::get_array_split_threshold();
+  lldc::reflection::batch::set_thread_count(3);
+
+  lldc::reflection::batch::set_array_split_threshold(0);
+  EXPECT_NO_THROW(serial = to_conversion(input));
+  lldc::reflection::batch::set_array_split_threshold(1000);
+  EXPECT_NO_THROW(split = to_conversion(input));
+  lldc::reflection::batch::set_array_split_threshold(threshold);
+
+  ASSERT_TRUE(serial);
+  ASSERT_TRUE(split);
+  EXPECT_TRUE(from_conversion(serial, serial_output));
+  EXPECT_TRUE(from_conversion(split, split_output));
+  EXPECT_EQ(input.v_int, split_output.v_int);
+  ASSERT_EQ(input.v_obj.size(), split_output.v_obj.size());
+  for (size_t i = 0; i < input.v_obj.size(); i++)
+    EXPECT_EQ(input.v_obj[i].name, split_output.v_obj[i].name);
+
+#if TEST_JSON
+  EXPECT_EQ(serial.text, split.text);
+#endif
+
+  uut_unref(serial);
+  uut_unref(split);
+}
+
+TEST(Async, ConvertsSnapshot) {
+  /**
+   * The queued object is a copy, so the caller can carry on changing its
+   * own; the result arrives through the future or the callback.
+   */
+  SecondMessage input, output, callback_output;
+  input.some_string = "queued";
+
+  auto future = to_async_conversion(::rttr::variant(input));
+  std::promise<uut_type> callback_result;
+  to_async_conversion(::rttr::variant(input), [&callback_result](auto result, std::exception_ptr error) {
+    EXPECT_FALSE(error);
+    uut_type value = result;
+    callback_result.set_value(value);
+  });
+  input.some_string = "changed";
+
+  uut_type temp = future.get();
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_EQ("queued", output.some_string);
+  uut_unref(temp);
+
+  temp = callback_result.get_future().get();
+  EXPECT_TRUE(from_conversion(temp, callback_output));
+  EXPECT_EQ("queued", callback_output.some_string);
+  uut_unref(temp);
+}
+
+TEST(Batch, RoundTripsInOrder) {
+  /**
+   * A batch comes back in the order it went in, with or without workers.
+   */
+  namespace CONVERTERS = lldc::reflection::converters;
+  const size_t count = 100;
+
+  for (size_t threads : {0, 3}) {
+    lldc::reflection::batch::set_thread_count(threads);
+    EXPECT_EQ(threads, lldc::reflection::batch::get_thread_count());
+
+    std::vector<SecondMessage> inputs(count), outputs(count);
+    std::vector<::rttr::instance> input_objects, output_objects;
+    for (size_t i = 0; i < count; i++) {
+      inputs[i].some_string = "message " + std::to_string(i);
+      inputs[i].some_int32 = static_cast<int32_t>(i);
+      input_objects.emplace_back(inputs[i]);
+      output_objects.emplace_back(outputs[i]);
+    }
+
+#if TEST_JSON_GLIB
+    auto converted = CONVERTERS::to_json_glib_batch(input_objects);
+    auto success = CONVERTERS::from_json_glib_batch(converted, output_objects);
+    EXPECT_THROW(CONVERTERS::from_json_glib_batch(std::span(converted).first(1), output_objects),
+      lldc::reflection::exceptions::BatchSizeMismatch);
+    for (auto node : converted)
+      uut_unref(node);
+
+#elif TEST_SOCKET_IO
+    auto converted = CONVERTERS::to_socket_io_batch(input_objects);
+    auto success = CONVERTERS::from_socket_io_batch(converted, output_objects);
+    EXPECT_THROW(CONVERTERS::from_socket_io_batch(std::span(converted).first(1), output_objects),
+      lldc::reflection::exceptions::BatchSizeMismatch);
+
+#elif TEST_JSON
+    auto converted = CONVERTERS::json::to_json_batch(input_objects);
+    auto success = CONVERTERS::json::from_json_batch(converted, output_objects);
+    EXPECT_THROW(CONVERTERS::json::from_json_batch(std::span(converted).first(1), output_objects),
+      lldc::reflection::exceptions::BatchSizeMismatch);
+#endif
+
+    ASSERT_EQ(count, converted.size());
+    ASSERT_EQ(count, success.size());
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_TRUE(success[i]) << "message " << i;
+      EXPECT_EQ(inputs[i].some_string, outputs[i].some_string);
+      EXPECT_EQ(inputs[i].some_int32, outputs[i].some_int32);
+    }
+  }
+}
+
+TEST(Stats, CountsConversionsByType) {
+  /**
+   * Once enabled, each conversion is counted against its type and converter.
+   */
+  namespace STATS = lldc::reflection::stats;
+  SecondMessage input, output;
+  uut_type temp = nullptr;
+  input.some_string = "something";
+
+#if TEST_JSON_GLIB
+  const auto to = STATS::Converter::to_json_glib, from = STATS::Converter::from_json_glib;
+#elif TEST_SOCKET_IO
+  const auto to = STATS::Converter::to_socket_io, from = STATS::Converter::from_socket_io;
+#elif TEST_JSON
+  const auto to = STATS::Converter::to_json, from = STATS::Converter::from_json;
+#endif
+
+  STATS::reset();
+  STATS::set_enabled(true);
+  EXPECT_NO_THROW(temp = to_conversion(input));
+  EXPECT_TRUE(from_conversion(temp, output));
+  EXPECT_FALSE(from_conversion(nullptr, output));
+  STATS::set_enabled(false);
+  EXPECT_TRUE(from_conversion(temp, output)); // not counted
+
+  const auto name = ::rttr::type::get<SecondMessage>().get_name().to_string();
+  size_t found = 0;
+  for (const auto &entry : STATS::snapshot()) {
+    if (entry.type != name)
+      continue;
+    found++;
+    if (entry.converter == to) {
+      EXPECT_EQ(1u, entry.calls);
+      EXPECT_EQ(0u, entry.failures);
+    }
+    else {
+      EXPECT_EQ(from, entry.converter);
+      EXPECT_EQ(2u, entry.calls);
+      EXPECT_EQ(1u, entry.failures);
+    }
+    EXPECT_LE(input.some_string.size(), entry.bytes);
+
+    uint64_t timed = 0;
+    for (auto count : entry.latency)
+      timed += count;
+    EXPECT_EQ(entry.calls, timed);
+  }
+  EXPECT_EQ(2u, found);
+
+  const auto text = STATS::to_prometheus();
+  EXPECT_NE(std::string::npos, text.find(
+    std::string("lldc_reflection_conversions_total{type=\"") + name + "\",converter=\"" +
+    STATS::converter_name(to) + "\"} 1\n"));
+
+  STATS::reset();
+  uut_unref(temp);
+}
+
+TEST(Trace, RecordsSpanPerObjectAndMember) {
+  /**
+   * A tracing context records a span for each object and member, in both
+   * directions, and only until it is stopped.
+   */
+  namespace TRACE = lldc::reflection::trace;
+  lldc::reflection::ConversionContext context;
+  SecondMessage input, output;
+  uut_type temp = nullptr;
+  input.some_string = "something";
+
+  EXPECT_EQ("", TRACE::stop(context));
+  TRACE::start(context);
+  EXPECT_NO_THROW(temp = to_conversion(input, context));
+#if TEST_JSON
+  EXPECT_TRUE(lldc::reflection::converters::json::from_json(temp.text, output, context));
+#else
+  EXPECT_TRUE(from_conversion(temp, output, context));
+#endif
+  const auto text = TRACE::stop(context);
+  EXPECT_EQ("", TRACE::stop(context));
+
+  const auto count = [&text](const std::string &what) {
+    size_t found = 0;
+    for (auto at = text.find(what); at != std::string::npos; at = text.find(what, at + 1))
+      found++;
+    return found;
+  };
+  EXPECT_EQ(0u, text.find("{\"traceEvents\":["));
+  EXPECT_EQ(2u, count("\"cat\":\"object\""));
+  EXPECT_EQ(2u, count("{\"name\":\"some_string\",\"cat\":\"member\""));
+  EXPECT_LE(2u, count("\"bytes\":9}"));
+
+  uut_unref(temp);
+}
+
 int main (int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();